@@ -6,44 +6,105 @@
 #include <sstream>
 #include <cctype>
 #include <stdexcept>
+#include <cstdint>
+#include <array>
+#include <iterator>
+#include <string_view>
+#include <charconv>
+#include <system_error>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <exception>
+#include <tuple>
+#include <shared_mutex>
+#include <unordered_map>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+
+// POLINOM_NO_MAIN:   ,    Google Test
+#ifndef POLINOM_NO_MAIN
 #include <gtest.h>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define POLINOM_X86_DISPATCH
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
-enum class ParseState {
-    Start,      //  
-    ReadCoeff,  //  
-    ReadVar,    //  
-    ReadPower   //  
-};
+inline void skipSpaces(string_view s, size_t& pos) {
+    while (pos < s.size() && isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+}
 
 class Monomial {
+public:
+    //   : x, y, z  powerBits 
+    static constexpr int powerBits = 16;
+    static constexpr int maxPower = (1 << powerBits) - 1;
+
+    static uint64_t makeKey(int px, int py, int pz) {
+        if (px < 0 || py < 0 || pz < 0 ||
+            px > maxPower || py > maxPower || pz > maxPower) {
+            throw runtime_error("Invalid degree");
+        }
+        return (uint64_t(px) << (2 * powerBits)) |
+            (uint64_t(py) << powerBits) |
+            uint64_t(pz);
+    }
+
 private:
     double coefficient;
-    int powerX, powerY, powerZ;
+    uint64_t key;
 
 public:
     // 
     Monomial(double coeff = 0, int px = 0, int py = 0, int pz = 0)
-        : coefficient(coeff), powerX(px), powerY(py), powerZ(pz) {
+        : coefficient(coeff), key(makeKey(px, py, pz)) {
     }
 
     Monomial(const string& str) {
         *this = parse(str);
     }
 
+    static Monomial fromKey(double coeff, uint64_t key) {
+        Monomial m(coeff);
+        m.key = key;
+        return m;
+    }
+
     // 
     double getCoefficient() const { return coefficient; }
-    int getPowerX() const { return powerX; }
-    int getPowerY() const { return powerY; }
-    int getPowerZ() const { return powerZ; }
+    uint64_t getKey() const { return key; }
+    int getPowerX() const { return int(key >> (2 * powerBits)) & maxPower; }
+    int getPowerY() const { return int(key >> powerBits) & maxPower; }
+    int getPowerZ() const { return int(key) & maxPower; }
 
     //  
     bool operator==(const Monomial& other) const {
-        return coefficient == other.coefficient &&
-            powerX == other.powerX &&
-            powerY == other.powerY &&
-            powerZ == other.powerZ;
+        return coefficient == other.coefficient && key == other.key;
     }
 
     bool operator!=(const Monomial& other) const {
@@ -64,389 +125,2955 @@ public:
     }
 
     bool isSimilar(const Monomial& other) const {
-        return powerX == other.powerX &&
-            powerY == other.powerY &&
-            powerZ == other.powerZ;
+        return key == other.key;
     }
 
+    //    : x,  y,  z
     bool operator<(const Monomial& other) const {
-        if (powerX != other.powerX) return powerX > other.powerX;
-        if (powerY != other.powerY) return powerY > other.powerY;
-        return powerZ > other.powerZ;
+        return key > other.key;
     }
 
     Monomial operator+(const Monomial& other) const {
         if (!isSimilar(other)) throw runtime_error("Cannot add different monomials");
-        return Monomial(coefficient + other.coefficient, powerX, powerY, powerZ);
+        return fromKey(coefficient + other.coefficient, key);
     }
 
     Monomial operator-(const Monomial& other) const {
         if (!isSimilar(other)) throw runtime_error("Cannot subtract different monomials");
-        return Monomial(coefficient - other.coefficient, powerX, powerY, powerZ);
+        return fromKey(coefficient - other.coefficient, key);
     }
 
     Monomial operator*(const Monomial& other) const {
-        if (powerX + other.powerX > 9 ||
-            powerY + other.powerY > 9 ||
-            powerZ + other.powerZ > 9) {
+        if (getPowerX() + other.getPowerX() > 9 ||
+            getPowerY() + other.getPowerY() > 9 ||
+            getPowerZ() + other.getPowerZ() > 9) {
             throw runtime_error("Degree overflow");
         }
-        return Monomial(
-            coefficient * other.coefficient,
-            powerX + other.powerX,
-            powerY + other.powerY,
-            powerZ + other.powerZ
-        );
+        //   ,    
+        return fromKey(coefficient * other.coefficient, key + other.key);
     }
 
     Monomial operator*(double scalar) const {
-        return Monomial(coefficient * scalar, powerX, powerY, powerZ);
+        return fromKey(coefficient * scalar, key);
     }
 
     Monomial operator/(double divisor) const {
         if (divisor == 0) throw runtime_error("Division by zero");
-        return Monomial(coefficient / divisor, powerX, powerY, powerZ);
+        return fromKey(coefficient / divisor, key);
     }
 
-    string toString() const {
-        if (coefficient == 0) return "0";
+    //       (. format)
+    static constexpr size_t maxFormattedLength = 48;
 
-        ostringstream oss;
-        if (coefficient != 1 && coefficient != -1 ||
-            (powerX == 0 && powerY == 0 && powerZ == 0)) {
-            oss << coefficient;
+    //       maxFormattedLength;  
+    // .     ostream   (%g, 6 )
+    char* format(char* out) const {
+        if (coefficient == 0) {
+            *out++ = '0';
+            return out;
+        }
+        if ((coefficient != 1 && coefficient != -1) ||
+            key == 0) {
+            out = to_chars(out, out + 24, coefficient, chars_format::general, 6).ptr;
         }
         else if (coefficient == -1) {
-            oss << "-";
+            *out++ = '-';
         }
 
-        if (powerX > 0) {
-            oss << "x";
-            if (powerX > 1) oss << "^" << powerX;
-        }
-        if (powerY > 0) {
-            oss << "y";
-            if (powerY > 1) oss << "^" << powerY;
-        }
-        if (powerZ > 0) {
-            oss << "z";
-            if (powerZ > 1) oss << "^" << powerZ;
+        const char names[3] = { 'x', 'y', 'z' };
+        const int powers[3] = { getPowerX(), getPowerY(), getPowerZ() };
+        for (int v = 0; v < 3; ++v) {
+            if (powers[v] > 0) {
+                *out++ = names[v];
+                if (powers[v] > 1) {
+                    *out++ = '^';
+                    out = to_chars(out, out + 8, powers[v]).ptr;
+                }
+            }
         }
+        return out;
+    }
 
-        return oss.str();
+    string toString() const {
+        char buffer[maxFormattedLength];
+        return string(buffer, format(buffer));
     }
 
-    static Monomial parse(const string& str) {
+    //    : [] {x|y|z [^]}, pos   
+    static Monomial parseTerm(string_view str, size_t& pos) {
         double coeff = 1.0;
-        int px = 0, py = 0, pz = 0;
-        string s = str;
-        s.erase(remove(s.begin(), s.end(), ' '), s.end());
-
-        ParseState state = ParseState::Start;
-        string buffer;
-        char currentVar = '\0';
-
-        for (char c : s) {
-            switch (state) {
-            case ParseState::Start:
-                if (c == '+' || c == '-') {
-                    buffer += c;
-                    state = ParseState::ReadCoeff;
-                }
-                else if (isdigit(c)) {
-                    buffer += c;
-                    state = ParseState::ReadCoeff;
-                }
-                else if (isalpha(c)) {
-                    currentVar = tolower(c);
-                    state = ParseState::ReadVar;
-                }
-                break;
-
-            case ParseState::ReadCoeff:
-                if (isdigit(c) || c == '.') {
-                    buffer += c;
-                }
-                else if (isalpha(c)) {
-                    if (!buffer.empty()) coeff = stod(buffer);
-                    currentVar = tolower(c);
-                    state = ParseState::ReadVar;
-                }
-                break;
-
-            case ParseState::ReadVar:
-                if (c == '^') {
-                    buffer.clear();
-                    state = ParseState::ReadPower;
-                }
-                else {
-                    //   1
-                    switch (currentVar) {
-                    case 'x': px = 1; break;
-                    case 'y': py = 1; break;
-                    case 'z': pz = 1; break;
-                    }
-                    currentVar = '\0';
-                    state = ParseState::Start;
-                }
-                break;
+        int powers[3] = { 0, 0, 0 };
+        bool empty = true;
+
+        skipSpaces(str, pos);
+        if (pos < str.size() && (isdigit(static_cast<unsigned char>(str[pos])) || str[pos] == '.')) {
+            auto res = from_chars(str.data() + pos, str.data() + str.size(), coeff);
+            if (res.ec != errc()) throw runtime_error("Invalid coefficient");
+            pos = res.ptr - str.data();
+            empty = false;
+        }
 
-            case ParseState::ReadPower:
-                if (isdigit(c)) {
-                    buffer += c;
-                }
-                else {
-                    int power = stoi(buffer);
-                    switch (currentVar) {
-                    case 'x': px = power; break;
-                    case 'y': py = power; break;
-                    case 'z': pz = power; break;
-                    }
-                    buffer.clear();
-                    state = ParseState::Start;
+        while (true) {
+            skipSpaces(str, pos);
+            if (pos == str.size()) break;
+            char var = static_cast<char>(tolower(static_cast<unsigned char>(str[pos])));
+            if (var < 'x' || var > 'z') break;
+            ++pos;
+            empty = false;
+
+            int power = 1;
+            skipSpaces(str, pos);
+            if (pos < str.size() && str[pos] == '^') {
+                skipSpaces(str, ++pos);
+                auto res = from_chars(str.data() + pos, str.data() + str.size(), power);
+                if (res.ec != errc() || power < 0 || power > maxPower) {
+                    throw runtime_error("Invalid degree");
                 }
-                break;
+                pos = res.ptr - str.data();
             }
+            powers[var - 'x'] += power;
         }
 
-        //   
-        if (!buffer.empty() && currentVar != '\0') {
-            int power = buffer.empty() ? 1 : stoi(buffer);
-            switch (currentVar) {
-            case 'x': px = power; break;
-            case 'y': py = power; break;
-            case 'z': pz = power; break;
-            }
-        }
+        if (empty) throw runtime_error("Invalid monomial");
+        return Monomial(coeff, powers[0], powers[1], powers[2]);
+    }
 
-        return Monomial(coeff, px, py, pz);
+    static Monomial parse(string_view str) {
+        size_t pos = 0;
+        skipSpaces(str, pos);
+        double sign = 1;
+        if (pos < str.size() && (str[pos] == '+' || str[pos] == '-')) {
+            if (str[pos++] == '-') sign = -1;
+        }
+        Monomial m = parseTerm(str, pos);
+        skipSpaces(str, pos);
+        if (pos != str.size()) throw runtime_error("Invalid monomial");
+        m.coefficient *= sign;
+        return m;
     }
 };
 
-class Polynomial {
+static_assert(sizeof(Monomial) == 16, "Monomial must stay 16 bytes");
+
+//      .
+//       
+class CoeffKernels {
+public:
+    enum class Level { Scalar, Avx2, Avx512 };
+
+    static Level detectedLevel() {
+        static const Level detected = detect();
+        return detected;
+    }
+
+    static Level level() { return active()->level; }
+
+    //    (  ),   
+    static void setLevel(Level requested) {
+        Level allowed = min(requested, detectedLevel());
+        active() = allowed == Level::Avx512 ? &avx512Table() :
+            allowed == Level::Avx2 ? &avx2Table() : &scalarTable();
+    }
+
+    // dst[i] += src[i]
+    static void add(double* dst, const double* src, size_t n) { active()->add(dst, src, n); }
+    // dst[i] -= src[i]
+    static void sub(double* dst, const double* src, size_t n) { active()->sub(dst, src, n); }
+    // dst[i] *= factor
+    static void scale(double* dst, double factor, size_t n) { active()->scale(dst, factor, n); }
+    // dst[i] /= divisor
+    static void divide(double* dst, double divisor, size_t n) { active()->divide(dst, divisor, n); }
+    // dst[i] += factor * src[i]
+    static void axpy(double* dst, const double* src, double factor, size_t n) {
+        active()->axpy(dst, src, factor, n);
+    }
+
 private:
-    vector<Monomial> terms;
+    struct Table {
+        Level level;
+        void (*add)(double*, const double*, size_t);
+        void (*sub)(double*, const double*, size_t);
+        void (*scale)(double*, double, size_t);
+        void (*divide)(double*, double, size_t);
+        void (*axpy)(double*, const double*, double, size_t);
+    };
+
+    static const Table*& active() {
+        static const Table* table = detectedLevel() == Level::Avx512 ? &avx512Table() :
+            detectedLevel() == Level::Avx2 ? &avx2Table() : &scalarTable();
+        return table;
+    }
+
+    static void addScalar(double* dst, const double* src, size_t n) {
+        for (size_t i = 0; i < n; ++i) dst[i] += src[i];
+    }
+    static void subScalar(double* dst, const double* src, size_t n) {
+        for (size_t i = 0; i < n; ++i) dst[i] -= src[i];
+    }
+    static void scaleScalar(double* dst, double factor, size_t n) {
+        for (size_t i = 0; i < n; ++i) dst[i] *= factor;
+    }
+    static void divideScalar(double* dst, double divisor, size_t n) {
+        for (size_t i = 0; i < n; ++i) dst[i] /= divisor;
+    }
+    static void axpyScalar(double* dst, const double* src, double factor, size_t n) {
+        for (size_t i = 0; i < n; ++i) dst[i] += factor * src[i];
+    }
 
-    void sortAndSimplify() {
-        sort(terms.begin(), terms.end());
-        vector<Monomial> simplified;
+    static const Table& scalarTable() {
+        static const Table table = { Level::Scalar, addScalar, subScalar, scaleScalar, divideScalar, axpyScalar };
+        return table;
+    }
 
-        for (auto& term : terms) {
-            if (term.getCoefficient() == 0) continue;
+#ifdef POLINOM_X86_DISPATCH
+    static Level detect() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Level::Avx512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Level::Avx2;
+        return Level::Scalar;
+    }
 
-            if (!simplified.empty() && simplified.back().isSimilar(term)) {
-                simplified.back() = simplified.back() + term;
-            }
-            else {
-                simplified.push_back(term);
-            }
+    __attribute__((target("avx2,fma")))
+    static void addAvx2(double* dst, const double* src, size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+        }
+        addScalar(dst + i, src + i, n - i);
+    }
+    __attribute__((target("avx2,fma")))
+    static void subAvx2(double* dst, const double* src, size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_sub_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+        }
+        subScalar(dst + i, src + i, n - i);
+    }
+    __attribute__((target("avx2,fma")))
+    static void scaleAvx2(double* dst, double factor, size_t n) {
+        __m256d f = _mm256_set1_pd(factor);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(dst + i), f));
+        }
+        scaleScalar(dst + i, factor, n - i);
+    }
+    __attribute__((target("avx2,fma")))
+    static void divideAvx2(double* dst, double divisor, size_t n) {
+        __m256d d = _mm256_set1_pd(divisor);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_div_pd(_mm256_loadu_pd(dst + i), d));
+        }
+        divideScalar(dst + i, divisor, n - i);
+    }
+    __attribute__((target("avx2,fma")))
+    static void axpyAvx2(double* dst, const double* src, double factor, size_t n) {
+        __m256d f = _mm256_set1_pd(factor);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_fmadd_pd(f, _mm256_loadu_pd(src + i), _mm256_loadu_pd(dst + i)));
+        }
+        axpyScalar(dst + i, src + i, factor, n - i);
+    }
+
+    __attribute__((target("avx512f")))
+    static void addAvx512(double* dst, const double* src, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+        }
+        addScalar(dst + i, src + i, n - i);
+    }
+    __attribute__((target("avx512f")))
+    static void subAvx512(double* dst, const double* src, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(dst + i, _mm512_sub_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+        }
+        subScalar(dst + i, src + i, n - i);
+    }
+    __attribute__((target("avx512f")))
+    static void scaleAvx512(double* dst, double factor, size_t n) {
+        __m512d f = _mm512_set1_pd(factor);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_loadu_pd(dst + i), f));
+        }
+        scaleScalar(dst + i, factor, n - i);
+    }
+    __attribute__((target("avx512f")))
+    static void divideAvx512(double* dst, double divisor, size_t n) {
+        __m512d d = _mm512_set1_pd(divisor);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(dst + i, _mm512_div_pd(_mm512_loadu_pd(dst + i), d));
+        }
+        divideScalar(dst + i, divisor, n - i);
+    }
+    __attribute__((target("avx512f")))
+    static void axpyAvx512(double* dst, const double* src, double factor, size_t n) {
+        __m512d f = _mm512_set1_pd(factor);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(dst + i, _mm512_fmadd_pd(f, _mm512_loadu_pd(src + i), _mm512_loadu_pd(dst + i)));
         }
-        terms = simplified;
+        axpyScalar(dst + i, src + i, factor, n - i);
     }
 
+    static const Table& avx2Table() {
+        static const Table table = { Level::Avx2, addAvx2, subAvx2, scaleAvx2, divideAvx2, axpyAvx2 };
+        return table;
+    }
+
+    static const Table& avx512Table() {
+        static const Table table = { Level::Avx512, addAvx512, subAvx512, scaleAvx512, divideAvx512, axpyAvx512 };
+        return table;
+    }
+#else
+    static Level detect() { return Level::Scalar; }
+    static const Table& avx2Table() { return scalarTable(); }
+    static const Table& avx512Table() { return scalarTable(); }
+#endif
+};
+
+//  :   10x10x10 ( 0..9).
+//  px*100 + py*10 + pz     Monomial
+class DensePolynomial {
 public:
-    // 
-    Polynomial() = default;
-    Polynomial(const string& str) { parse(str); }
+    static constexpr int side = 10;
+    static constexpr int volume = side * side * side;
 
-    // 
-    Polynomial operator+(const Polynomial& other) const {
-        Polynomial result = *this;
-        result.terms.insert(result.terms.end(), other.terms.begin(), other.terms.end());
-        result.sortAndSimplify();
-        return result;
+    static bool fits(uint64_t key) {
+        Monomial m = Monomial::fromKey(0, key);
+        return m.getPowerX() < side && m.getPowerY() < side && m.getPowerZ() < side;
     }
 
-    Polynomial operator-(const Polynomial& other) const {
-        Polynomial result = *this;
-        for (const auto& term : other.terms) {
-            result.terms.push_back(term * -1);
-        }
-        result.sortAndSimplify();
-        return result;
+    static int index(uint64_t key) {
+        Monomial m = Monomial::fromKey(0, key);
+        return (m.getPowerX() * side + m.getPowerY()) * side + m.getPowerZ();
     }
 
-    Polynomial operator*(const Polynomial& other) const {
-        Polynomial result;
-        for (const auto& t1 : terms) {
-            for (const auto& t2 : other.terms) {
-                result.terms.push_back(t1 * t2);
-            }
-        }
-        result.sortAndSimplify();
-        return result;
+    static uint64_t keyAt(int idx) {
+        return Monomial::makeKey(idx / (side * side), idx / side % side, idx % side);
     }
 
-    Polynomial operator/(double divisor) const {
-        if (divisor == 0) throw runtime_error("Division by zero");
-        Polynomial result = *this;
-        for (auto& term : result.terms) {
-            term = term / divisor;
-        }
+private:
+    array<double, volume> coeffs;
+    //       (-1  )
+    int maxX = -1, maxY = -1, maxZ = -1;
+
+    void extend(int px, int py, int pz) {
+        maxX = max(maxX, px);
+        maxY = max(maxY, py);
+        maxZ = max(maxZ, pz);
+    }
+
+    DensePolynomial combine(const DensePolynomial& other, double sign) const {
+        DensePolynomial result = *this;
+        if (sign > 0) CoeffKernels::add(result.coeffs.data(), other.coeffs.data(), volume);
+        else CoeffKernels::sub(result.coeffs.data(), other.coeffs.data(), volume);
+        result.maxX = max(maxX, other.maxX);
+        result.maxY = max(maxY, other.maxY);
+        result.maxZ = max(maxZ, other.maxZ);
         return result;
     }
 
-    // 
-    enum class ParseState { Start, ReadCoeff, ReadVar, ReadPower, End };
+public:
+    DensePolynomial() { coeffs.fill(0); }
 
-    void parse(const string& str) {
-        terms.clear();
-        string s = str;
-        s.erase(remove(s.begin(), s.end(), ' '), s.end());
+    void add(uint64_t key, double coeff) {
+        if (!fits(key)) throw runtime_error("Degree overflow");
+        Monomial m = Monomial::fromKey(coeff, key);
+        coeffs[index(key)] += coeff;
+        extend(m.getPowerX(), m.getPowerY(), m.getPowerZ());
+    }
 
-        ParseState state = ParseState::Start;
-        char currentSign = '+';
-        string currentTerm;
-        size_t pos = 0;
+    double getCoefficient(int px, int py, int pz) const {
+        return coeffs[(px * side + py) * side + pz];
+    }
 
-        while (pos < s.size()) {
-            char c = s[pos];
+    const double* data() const { return coeffs.data(); }
 
-            switch (state) {
-            case ParseState::Start:
-                if (c == '+' || c == '-') {
-                    currentSign = c;
-                    pos++;
-                }
-                state = ParseState::ReadCoeff;
-                currentTerm.clear();
-                break;
+    //       (  )
+    template <class F>
+    void forEachTerm(F f) const {
+        for (int idx = volume - 1; idx >= 0; --idx) {
+            if (coeffs[idx] != 0) f(keyAt(idx), coeffs[idx]);
+        }
+    }
 
-            case ParseState::ReadCoeff:
-                if (isdigit(c) || c == '.') {
-                    currentTerm += c;
-                    pos++;
-                }
-                else {
-                    state = ParseState::ReadVar;
-                }
-                break;
+    DensePolynomial operator+(const DensePolynomial& other) const {
+        return combine(other, 1);
+    }
 
-            case ParseState::ReadVar:
-                if (isalpha(c)) {
-                    currentTerm += c;
-                    pos++;
-                }
-                else if (c == '^') {
-                    state = ParseState::ReadPower;
-                    pos++;
-                }
-                else {
-                    //   
-                    Monomial m(currentTerm);
-                    if (currentSign == '-') m = m * -1;
-                    terms.push_back(m);
-                    state = ParseState::Start;
-                }
-                break;
+    DensePolynomial operator-(const DensePolynomial& other) const {
+        return combine(other, -1);
+    }
 
-            case ParseState::ReadPower:
-                if (isdigit(c)) {
-                    currentTerm += '^';
-                    currentTerm += c;
-                    pos++;
-                }
-                else {
-                    state = ParseState::ReadVar;
+    DensePolynomial operator*(double scalar) const {
+        DensePolynomial result = *this;
+        CoeffKernels::scale(result.coeffs.data(), scalar, volume);
+        return result;
+    }
+
+    DensePolynomial operator/(double divisor) const {
+        if (divisor == 0) throw runtime_error("Division by zero");
+        DensePolynomial result = *this;
+        CoeffKernels::divide(result.coeffs.data(), divisor, volume);
+        return result;
+    }
+
+    // :    a[i]  a[i] * b  
+    // ,       z
+    DensePolynomial operator*(const DensePolynomial& other) const {
+        DensePolynomial result;
+        if (maxX < 0 || other.maxX < 0) return result;
+        if (maxX + other.maxX >= side || maxY + other.maxY >= side || maxZ + other.maxZ >= side) {
+            throw runtime_error("Degree overflow");
+        }
+        int rowZ = other.maxZ + 1;
+        for (int ax = 0; ax <= maxX; ++ax) {
+            for (int ay = 0; ay <= maxY; ++ay) {
+                for (int az = 0; az <= maxZ; ++az) {
+                    double c = coeffs[(ax * side + ay) * side + az];
+                    if (c == 0) continue;
+                    for (int bx = 0; bx <= other.maxX; ++bx) {
+                        for (int by = 0; by <= other.maxY; ++by) {
+                            double* dst = &result.coeffs[((ax + bx) * side + ay + by) * side + az];
+                            const double* src = &other.coeffs[(bx * side + by) * side];
+                            CoeffKernels::axpy(dst, src, c, rowZ);
+                        }
+                    }
                 }
-                break;
             }
         }
+        result.maxX = maxX + other.maxX;
+        result.maxY = maxY + other.maxY;
+        result.maxZ = maxZ + other.maxZ;
+        return result;
+    }
+};
+
+//       :   
+//   ; ,   ,    
+//     ,       
+class ThreadPool {
+private:
+    struct Queue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    vector<unique_ptr<Queue>> queues;
+    vector<thread> workers;
+    mutex sleepLock;
+    condition_variable wake;
+    atomic<size_t> pending{ 0 };
+    atomic<size_t> nextQueue{ 0 };
+    bool stopping = false;
+
+    //    ,     
+    static pair<const ThreadPool*, size_t>& current() {
+        static thread_local pair<const ThreadPool*, size_t> owner(nullptr, 0);
+        return owner;
+    }
 
-        //   ,   
-        if (!currentTerm.empty()) {
-            Monomial m(currentTerm);
-            if (currentSign == '-') m = m * -1;
-            terms.push_back(m);
+    bool tryPop(size_t self, function<void()>& task) {
+        for (size_t k = 0; k < queues.size(); ++k) {
+            Queue& queue = *queues[(self + k) % queues.size()];
+            lock_guard<mutex> guard(queue.lock);
+            if (queue.tasks.empty()) continue;
+            if (k == 0) {
+                task = move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {
+                task = move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            --pending;
+            return true;
         }
+        return false;
+    }
 
-        sortAndSimplify();
+    void run(size_t self) {
+        current() = make_pair(this, self);
+        while (true) {
+            function<void()> task;
+            if (tryPop(self, task)) {
+                task();
+                continue;
+            }
+            unique_lock<mutex> guard(sleepLock);
+            wake.wait(guard, [this] { return stopping || pending > 0; });
+            if (stopping && pending == 0) return;
+        }
     }
 
-    void addTerm(const Monomial& m) {
-        terms.push_back(m);
-        sortAndSimplify();
+public:
+    explicit ThreadPool(size_t threads = thread::hardware_concurrency()) {
+        threads = max<size_t>(threads, 1);
+        for (size_t i = 0; i < threads; ++i) queues.push_back(make_unique<Queue>());
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this, i] { run(i); });
+        }
     }
 
-    string toString() const {
-        if (terms.empty()) return "0";
-        ostringstream oss;
-        for (size_t i = 0; i < terms.size(); ++i) {
-            string term = terms[i].toString();
-            if (i > 0 && term[0] != '-') oss << "+";
-            oss << term;
+    //     
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(sleepLock);
+            stopping = true;
         }
-        return oss.str();
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
     }
 
-    const vector<Monomial>& getTerms() const { return terms; }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
 
-    friend ostream& operator<<(ostream& os, const Polynomial& p) {
-        os << p.toString();
-        return os;
+    size_t size() const { return workers.size(); }
+
+    void submit(function<void()> task) {
+        size_t target = current().first == this ? current().second : nextQueue++ % queues.size();
+        {
+            lock_guard<mutex> guard(queues[target]->lock);
+            queues[target]->tasks.push_back(move(task));
+        }
+        {
+            lock_guard<mutex> guard(sleepLock);
+            ++pending;
+        }
+        wake.notify_one();
     }
 
-    friend istream& operator>>(istream& is, Polynomial& p) {
-        string input;
-        getline(is, input);
-        p.parse(input);
-        return is;
+    //       ;  ,
+    //    ,   
+    bool runPending() {
+        function<void()> task;
+        if (!tryPop(current().first == this ? current().second : 0, task)) return false;
+        task();
+        return true;
     }
 
-    bool operator==(const Polynomial& other) const {
-        return toString() == other.toString();
+    //    [0, n):   chunk   
+    //       ; body(begin, end).
+    //    body  
+    template <class F>
+    void parallelFor(size_t n, size_t chunk, F body) {
+        chunk = max<size_t>(chunk, 1);
+        size_t chunks = (n + chunk - 1) / chunk;
+        if (chunks <= 1) {
+            if (n > 0) body(size_t(0), n);
+            return;
+        }
+
+        // ,      ,  ,
+        //      
+        struct State {
+            atomic<size_t> next{ 0 };
+            size_t active = 1;
+            exception_ptr error;
+            mutex lock;
+            condition_variable done;
+        };
+        auto state = make_shared<State>();
+
+        auto work = [state, n, chunk, body](bool helper) {
+            if (helper) {
+                lock_guard<mutex> guard(state->lock);
+                if (state->next >= n) return;
+                ++state->active;
+            }
+            try {
+                for (size_t begin; (begin = state->next.fetch_add(chunk)) < n;) {
+                    body(begin, min(begin + chunk, n));
+                }
+            }
+            catch (...) {
+                lock_guard<mutex> guard(state->lock);
+                if (!state->error) state->error = current_exception();
+                state->next = n;
+            }
+            lock_guard<mutex> guard(state->lock);
+            if (--state->active == 0) state->done.notify_all();
+        };
+        size_t helpers = min(size(), chunks - 1);
+        for (size_t i = 0; i < helpers; ++i) submit([work] { work(true); });
+        work(false);
+
+        unique_lock<mutex> guard(state->lock);
+        state->done.wait(guard, [&] { return state->active == 0; });
+        if (state->error) rethrow_exception(state->error);
     }
 
-    bool operator!=(const Polynomial& other) const {
-        return !(*this == other);
+    //     
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
     }
 };
 
-class PolynomialStorage {
+//   :     
+//   ;    Monomial  
+class TermsView {
 private:
-    map<string, Polynomial> polynomials;
+    const uint64_t* keyData;
+    const double* coeffData;
+    size_t count;
 
 public:
-    void add(const string& name, const Polynomial& poly) {
-        if (polynomials.count(name)) {
-            cout << " '" << name << "'  . ? (y/n): ";
-            char choice;
-            cin >> choice;
-            cin.ignore();
-            if (tolower(choice) != 'y') return;
+    //      ,    ,
+    //    TermsView (, getTerms().begin()).
+    //    ,  input_iterator_tag
+    class iterator {
+    private:
+        const uint64_t* keyData;
+        const double* coeffData;
+        size_t pos;
+
+    public:
+        using iterator_category = input_iterator_tag;
+        using value_type = Monomial;
+        using difference_type = ptrdiff_t;
+        using pointer = void;
+        using reference = Monomial;
+
+        iterator(const uint64_t* keys, const double* coeffs, size_t p)
+            : keyData(keys), coeffData(coeffs), pos(p) {
+        }
+        Monomial operator*() const { return Monomial::fromKey(coeffData[pos], keyData[pos]); }
+        iterator& operator++() { ++pos; return *this; }
+        iterator operator++(int) { iterator old = *this; ++pos; return old; }
+        bool operator==(const iterator& other) const { return pos == other.pos; }
+        bool operator!=(const iterator& other) const { return pos != other.pos; }
+    };
+
+    TermsView(const uint64_t* keys, const double* coeffs, size_t n)
+        : keyData(keys), coeffData(coeffs), count(n) {
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Monomial operator[](size_t i) const { return Monomial::fromKey(coeffData[i], keyData[i]); }
+    iterator begin() const { return iterator(keyData, coeffData, 0); }
+    iterator end() const { return iterator(keyData, coeffData, count); }
+
+    const uint64_t* keys() const { return keyData; }
+    const double* coefficients() const { return coeffData; }
+};
+
+template <class E>
+class PolyExpr;
+class EvaluationPlan;
+
+class Polynomial {
+private:
+    friend class PolyAccumulator;
+    friend class EvaluationPlan;
+
+    //     (  ),   
+    vector<uint64_t> keys;
+    vector<double> coeffs;
+
+    //  ,     (0 -   ).
+    // , ..     const-    
+    // (ConcurrentPolynomialStorage);    
+    struct HashCache {
+        mutable atomic<uint64_t> value{ 0 };
+
+        HashCache() = default;
+        HashCache(const HashCache& other) : value(other.value.load(memory_order_relaxed)) {}
+        HashCache(HashCache&& other) noexcept : value(other.value.exchange(0, memory_order_relaxed)) {}
+        HashCache& operator=(const HashCache& other) {
+            value.store(other.value.load(memory_order_relaxed), memory_order_relaxed);
+            return *this;
+        }
+        HashCache& operator=(HashCache&& other) noexcept {
+            value.store(other.value.exchange(0, memory_order_relaxed), memory_order_relaxed);
+            return *this;
+        }
+    };
+    HashCache cachedHash;
+
+    //    
+    void touch() { cachedHash.value.store(0, memory_order_relaxed); }
+
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebull;
+        return h ^ (h >> 31);
+    }
+
+    uint64_t computeHash() const {
+        uint64_t h = mix(size() + 0x9e3779b97f4a7c15ull);
+        for (size_t i = 0; i < size(); ++i) {
+            uint64_t bits;
+            memcpy(&bits, &coeffs[i], sizeof(bits));
+            h = mix(h ^ keys[i]);
+            h = mix(h ^ bits);
+        }
+        return h == 0 ? 1 : h;
+    }
+
+    size_t size() const { return keys.size(); }
+
+    void reserve(size_t n) {
+        keys.reserve(n);
+        coeffs.reserve(n);
+    }
+
+    void append(uint64_t key, double coeff) {
+        touch();
+        keys.push_back(key);
+        coeffs.push_back(coeff);
+    }
+
+    // pool == nullptr -  ,   ( )  ,
+    //      
+    void sortAndSimplify(ThreadPool* pool = nullptr) {
+        touch();
+        if (size() >= bucketSortThreshold && bucketSortAndSimplify(pool)) return;
+
+        vector<Monomial> terms(size());
+        for (size_t i = 0; i < size(); ++i) terms[i] = Monomial::fromKey(coeffs[i], keys[i]);
+        sort(terms.begin(), terms.end(), [](const Monomial& a, const Monomial& b) {
+            return a.getKey() > b.getKey();
+        });
+
+        //  ,   
+        size_t count = 0;
+        for (size_t i = 0; i < terms.size();) {
+            uint64_t key = terms[i].getKey();
+            double coeff = 0;
+            for (; i < terms.size() && terms[i].getKey() == key; ++i) {
+                coeff += terms[i].getCoefficient();
+            }
+            if (coeff != 0) {
+                keys[count] = key;
+                coeffs[count] = coeff;
+                ++count;
+            }
         }
-        polynomials[name] = poly;
-        cout << " '" << name << "' .\n";
+        keys.resize(count);
+        coeffs.resize(count);
     }
 
-    void remove(const string& name) {
-        if (polynomials.erase(name)) {
-            cout << " '" << name << "' .\n";
+    //    10x10x10,     
+    // 1000     : O(n + 1000)  .
+    //         .
+    // false,  -     
+    bool bucketSortAndSimplify(ThreadPool* pool) {
+        array<double, DensePolynomial::volume> buckets{};
+        bool parallel = false;
+        if (size() >= parallelSimplifyThreshold) {
+            if (!pool) pool = &ThreadPool::shared();
+            parallel = pool->size() > 1;
+        }
+        if (parallel) {
+            if (!accumulateParallel(buckets, *pool)) return false;
         }
         else {
-            cout << " '" << name << "'  .\n";
+            for (uint64_t key : keys) {
+                if (!DensePolynomial::fits(key)) return false;
+            }
+            for (size_t i = 0; i < size(); ++i) buckets[DensePolynomial::index(keys[i])] += coeffs[i];
+        }
+
+        size_t count = 0;
+        for (int idx = DensePolynomial::volume - 1; idx >= 0; --idx) {
+            if (buckets[idx] != 0) {
+                keys[count] = DensePolynomial::keyAt(idx);
+                coeffs[count] = buckets[idx];
+                ++count;
+            }
+        }
+        keys.resize(count);
+        coeffs.resize(count);
+        return true;
+    }
+
+    //     :      
+    // ,       (  
+    //  ,    )
+    bool accumulateParallel(array<double, DensePolynomial::volume>& buckets, ThreadPool& pool) const {
+        size_t chunk = max<size_t>(size() / (4 * pool.size()), 1 << 14);
+        vector<array<double, DensePolynomial::volume>> partials((size() + chunk - 1) / chunk);
+        atomic<bool> outside{ false };
+        pool.parallelFor(size(), chunk, [&](size_t begin, size_t end) {
+            array<double, DensePolynomial::volume>& part = partials[begin / chunk];
+            part.fill(0);
+            for (size_t i = begin; i < end; ++i) {
+                if (!DensePolynomial::fits(keys[i])) {
+                    outside = true;
+                    return;
+                }
+                part[DensePolynomial::index(keys[i])] += coeffs[i];
+            }
+        });
+        if (outside) return false;
+        for (const auto& part : partials) CoeffKernels::add(buckets.data(), part.data(), DensePolynomial::volume);
+        return true;
+    }
+
+    void maxPowers(int& px, int& py, int& pz) const {
+        px = py = pz = 0;
+        for (uint64_t key : keys) {
+            Monomial m = Monomial::fromKey(0, key);
+            px = max(px, m.getPowerX());
+            py = max(py, m.getPowerY());
+            pz = max(pz, m.getPowerZ());
+        }
+    }
+
+    //     : a + sign * b  O(n + m)
+    static Polynomial merge(const Polynomial& a, const Polynomial& b, double sign) {
+        Polynomial result;
+        result.reserve(a.size() + b.size());
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size()) {
+            uint64_t ka = a.keys[i], kb = b.keys[j];
+            if (ka > kb) {
+                result.append(ka, a.coeffs[i++]);
+            }
+            else if (ka < kb) {
+                result.append(kb, sign * b.coeffs[j++]);
+            }
+            else {
+                double coeff = a.coeffs[i++] + sign * b.coeffs[j++];
+                if (coeff != 0) result.append(ka, coeff);
+            }
         }
+        for (; i < a.size(); ++i) result.append(a.keys[i], a.coeffs[i]);
+        for (; j < b.size(); ++j) result.append(b.keys[j], sign * b.coeffs[j]);
+        return result;
     }
 
-    Polynomial get(const string& name) const {
-        auto it = polynomials.find(name);
-        if (it == polynomials.end()) {
-            throw runtime_error("  ");
+    // table[d * evalBlock + l] = v[l]^d;     
+    static void fillPowers(const double* v, size_t lanes, int maxPow, double* table) {
+        for (size_t l = 0; l < evalBlock; ++l) {
+            table[l] = 1;
+            if (maxPow > 0) table[evalBlock + l] = l < lanes ? v[l] : 0;
+        }
+        for (int d = 2; d <= maxPow; ++d) {
+            for (size_t l = 0; l < evalBlock; ++l) {
+                table[d * evalBlock + l] = table[(d - 1) * evalBlock + l] * table[evalBlock + l];
+            }
         }
-        return it->second;
     }
 
-    void list() const {
-        if (polynomials.empty()) {
-            cout << "  .\n";
+    //        n 
+    static size_t chainCapacity(size_t n) {
+        return 2 * n;
+    }
+
+    // this += sign * other   ,   :  
+    //    ,     ,   
+    void mergeInPlace(const Polynomial& other, double sign) {
+        touch();
+        if (&other == this) {
+            if (sign > 0) CoeffKernels::scale(coeffs.data(), 2, size());
+            else clear();
             return;
         }
-        cout << " :\n";
-        for (const auto& entry : polynomials) {
-            cout << "  " << entry.first << " = " << entry.second << endl;
+        size_t n = size(), m = other.size();
+        if (m == 0) return;
+
+        //   n + m ;    , 
+        //    a + b + c + ...     
+        if (keys.capacity() < n + m) reserve(chainCapacity(n + m));
+        keys.resize(n + m);
+        coeffs.resize(n + m);
+        move_backward(keys.begin(), keys.begin() + n, keys.end());
+        move_backward(coeffs.begin(), coeffs.begin() + n, coeffs.end());
+
+        size_t i = m, j = 0, w = 0;
+        while (i < n + m && j < m) {
+            uint64_t ka = keys[i], kb = other.keys[j];
+            if (ka > kb) {
+                keys[w] = ka;
+                coeffs[w++] = coeffs[i++];
+            }
+            else if (ka < kb) {
+                keys[w] = kb;
+                coeffs[w++] = sign * other.coeffs[j++];
+            }
+            else {
+                double coeff = coeffs[i++] + sign * other.coeffs[j++];
+                if (coeff != 0) {
+                    keys[w] = ka;
+                    coeffs[w++] = coeff;
+                }
+            }
+        }
+        for (; i < n + m; ++i, ++w) {
+            keys[w] = keys[i];
+            coeffs[w] = coeffs[i];
         }
+        for (; j < m; ++j, ++w) {
+            keys[w] = other.keys[j];
+            coeffs[w] = sign * other.coeffs[j];
+        }
+        keys.resize(w);
+        coeffs.resize(w);
     }
-};
+
+    void clear() {
+        touch();
+        keys.clear();
+        coeffs.clear();
+    }
+
+public:
+    //    ,        
+    static constexpr double denseFillRatio = 0.25;
+    //   ,      
+    static constexpr size_t parallelMultiplyThreshold = 1 << 16;
+    //  ,        
+    static constexpr size_t bucketSortThreshold = 64;
+    //  ,      
+    static constexpr size_t parallelSimplifyThreshold = 1 << 18;
+
+    // 
+    Polynomial() = default;
+    Polynomial(const string& str) { parse(str); }
+
+    //    (. lazy)
+    template <class E>
+    Polynomial(const PolyExpr<E>& expr) : Polynomial(expr.self().evaluate()) {}
+
+    template <class E>
+    Polynomial& operator=(const PolyExpr<E>& expr) {
+        return *this = expr.self().evaluate();
+    }
+
+    explicit Polynomial(const DensePolynomial& dense) {
+        dense.forEachTerm([this](uint64_t key, double coeff) {
+            append(key, coeff);
+        });
+    }
+
+    DensePolynomial toDense() const {
+        DensePolynomial dense;
+        for (size_t i = 0; i < size(); ++i) {
+            dense.add(keys[i], coeffs[i]);
+        }
+        return dense;
+    }
+
+    // 
+    Polynomial operator+(const Polynomial& other) const& {
+        return merge(*this, other, 1);
+    }
+
+    //      : a + b + c + d
+    Polynomial operator+(const Polynomial& other)&& {
+        *this += other;
+        return move(*this);
+    }
+
+    Polynomial operator-(const Polynomial& other) const& {
+        return merge(*this, other, -1);
+    }
+
+    Polynomial operator-(const Polynomial& other)&& {
+        *this -= other;
+        return move(*this);
+    }
+
+    Polynomial operator*(const Polynomial& other) const {
+        Polynomial result;
+        if (keys.empty() || other.keys.empty()) return result;
+
+        //   -     
+        int ax, ay, az, bx, by, bz;
+        maxPowers(ax, ay, az);
+        other.maxPowers(bx, by, bz);
+        if (ax + bx > 9 || ay + by > 9 || az + bz > 9) {
+            throw runtime_error("Degree overflow");
+        }
+
+        if (size() * other.size() >= parallelMultiplyThreshold && ThreadPool::shared().size() > 1) {
+            return multiplyParallel(other, ThreadPool::shared());
+        }
+
+        //       10x10x10
+        if (double(size()) >= denseFillRatio * (ax + 1) * (ay + 1) * (az + 1) &&
+            double(other.size()) >= denseFillRatio * (bx + 1) * (by + 1) * (bz + 1)) {
+            return Polynomial(toDense() * other.toDense());
+        }
+
+        //   ( ):  i  a[i] * b[0..m),
+        //     ,   
+        const Polynomial& a = size() <= other.size() ? *this : other;
+        const Polynomial& b = size() <= other.size() ? other : *this;
+
+        struct Stream {
+            uint64_t key;
+            uint32_t i, j;
+            bool operator<(const Stream& other) const { return key < other.key; }
+        };
+        vector<Stream> heap;
+        heap.reserve(a.size());
+        for (uint32_t i = 0; i < a.size(); ++i) {
+            heap.push_back({ a.keys[i] + b.keys[0], i, 0 });
+        }
+        make_heap(heap.begin(), heap.end());
+
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end());
+            Stream top = heap.back();
+            heap.pop_back();
+
+            double coeff = a.coeffs[top.i] * b.coeffs[top.j];
+            if (!result.keys.empty() && result.keys.back() == top.key) {
+                coeff += result.coeffs.back();
+                result.keys.pop_back();
+                result.coeffs.pop_back();
+            }
+            if (coeff != 0) result.append(top.key, coeff);
+
+            if (++top.j < b.size()) {
+                top.key = a.keys[top.i] + b.keys[top.j];
+                heap.push_back(top);
+                push_heap(heap.begin(), heap.end());
+            }
+        }
+        return result;
+    }
+
+    //  :      x 
+    // (0..9)        10x10  (y, z),
+    //    
+    Polynomial multiplyParallel(const Polynomial& other, ThreadPool& pool) const {
+        Polynomial result;
+        if (keys.empty() || other.keys.empty()) return result;
+        int ax, ay, az, bx, by, bz;
+        maxPowers(ax, ay, az);
+        other.maxPowers(bx, by, bz);
+        if (ax + bx > 9 || ay + by > 9 || az + bz > 9) {
+            throw runtime_error("Degree overflow");
+        }
+
+        //     x  :  
+        const int side = DensePolynomial::side;
+        array<size_t, DensePolynomial::side + 1> groupA, groupB;
+        auto groups = [side](const Polynomial& p, array<size_t, DensePolynomial::side + 1>& bounds) {
+            size_t t = p.size();
+            for (int x = 0; x <= side; ++x) {
+                while (t > 0 && Monomial::fromKey(0, p.keys[t - 1]).getPowerX() < x) --t;
+                bounds[x] = t;  //    x: [bounds[x + 1], bounds[x])
+            }
+        };
+        groups(*this, groupA);
+        groups(other, groupB);
+
+        int degrees = ax + bx + 1;
+        vector<Polynomial> slices(degrees);
+        pool.parallelFor(size_t(degrees), 1, [&](size_t begin, size_t end) {
+            for (size_t d = begin; d < end; ++d) {
+                array<double, DensePolynomial::side * DensePolynomial::side> acc;
+                acc.fill(0);
+                for (int xa = max(0, int(d) - bx); xa <= min(int(d), ax); ++xa) {
+                    int xb = int(d) - xa;
+                    for (size_t i = groupA[xa + 1]; i < groupA[xa]; ++i) {
+                        Monomial ma = Monomial::fromKey(coeffs[i], keys[i]);
+                        int base = ma.getPowerY() * side + ma.getPowerZ();
+                        for (size_t j = groupB[xb + 1]; j < groupB[xb]; ++j) {
+                            Monomial mb = Monomial::fromKey(0, other.keys[j]);
+                            acc[base + mb.getPowerY() * side + mb.getPowerZ()] +=
+                                ma.getCoefficient() * other.coeffs[j];
+                        }
+                    }
+                }
+                Polynomial& slice = slices[d];
+                for (int idx = side * side - 1; idx >= 0; --idx) {
+                    if (acc[idx] != 0) slice.append(Monomial::makeKey(int(d), idx / side, idx % side), acc[idx]);
+                }
+            }
+        });
+
+        size_t total = 0;
+        for (const auto& slice : slices) total += slice.size();
+        result.reserve(total);
+        for (int d = degrees - 1; d >= 0; --d) {
+            result.keys.insert(result.keys.end(), slices[d].keys.begin(), slices[d].keys.end());
+            result.coeffs.insert(result.coeffs.end(), slices[d].coeffs.begin(), slices[d].coeffs.end());
+        }
+        return result;
+    }
+
+    Polynomial operator/(double divisor) const& {
+        Polynomial result = *this;
+        result /= divisor;
+        return result;
+    }
+
+    Polynomial operator/(double divisor)&& {
+        *this /= divisor;
+        return move(*this);
+    }
+
+    Polynomial operator*(double scalar) const& {
+        Polynomial result = *this;
+        result *= scalar;
+        return result;
+    }
+
+    Polynomial operator*(double scalar)&& {
+        *this *= scalar;
+        return move(*this);
+    }
+
+    //     
+    Polynomial& operator+=(const Polynomial& other) {
+        mergeInPlace(other, 1);
+        return *this;
+    }
+
+    Polynomial& operator-=(const Polynomial& other) {
+        mergeInPlace(other, -1);
+        return *this;
+    }
+
+    Polynomial& operator*=(const Polynomial& other) {
+        *this = *this * other;
+        return *this;
+    }
+
+    Polynomial& operator/=(double divisor) {
+        if (divisor == 0) throw runtime_error("Division by zero");
+        touch();
+        CoeffKernels::divide(coeffs.data(), divisor, size());
+        return *this;
+    }
+
+    Polynomial& operator*=(double scalar) {
+        touch();
+        if (scalar == 0) clear();
+        else CoeffKernels::scale(coeffs.data(), scalar, size());
+        return *this;
+    }
+
+    // 
+    //      string_view:     ,
+    //      
+    void parse(string_view str) {
+        Polynomial result;
+        result.reserve(count(str.begin(), str.end(), '+') + count(str.begin(), str.end(), '-') + 1);
+
+        size_t pos = 0;
+        bool first = true;
+        while (true) {
+            skipSpaces(str, pos);
+            if (pos == str.size()) break;
+
+            double sign = 1;
+            if (str[pos] == '+' || str[pos] == '-') {
+                if (str[pos++] == '-') sign = -1;
+            }
+            else if (!first) {
+                throw runtime_error("Invalid polynomial");
+            }
+            Monomial m = Monomial::parseTerm(str, pos);
+            result.append(m.getKey(), sign * m.getCoefficient());
+            first = false;
+        }
+
+        result.sortAndSimplify();
+        *this = move(result);
+    }
+
+    //   .     v^0..v^max, 
+    //    evalBlock:      
+    //   
+    static constexpr size_t evalBlock = 16;
+
+    //  :    1,    evalBlock 
+    double evaluate(double x, double y, double z) const {
+        int mx, my, mz;
+        maxPowers(mx, my, mz);
+        size_t rows = size_t(mx) + my + mz + 3;
+        double local[3 * DensePolynomial::side];
+        vector<double> heap;
+        double* xp = local;
+        if (rows > 3 * DensePolynomial::side) {
+            heap.resize(rows);
+            xp = heap.data();
+        }
+        double* yp = xp + mx + 1;
+        double* zp = yp + my + 1;
+        xp[0] = yp[0] = zp[0] = 1;
+        for (int d = 1; d <= mx; ++d) xp[d] = xp[d - 1] * x;
+        for (int d = 1; d <= my; ++d) yp[d] = yp[d - 1] * y;
+        for (int d = 1; d <= mz; ++d) zp[d] = zp[d - 1] * z;
+
+        double result = 0;
+        for (size_t t = 0; t < size(); ++t) {
+            Monomial m = Monomial::fromKey(0, keys[t]);
+            result += coeffs[t] * xp[m.getPowerX()] * yp[m.getPowerY()] * zp[m.getPowerZ()];
+        }
+        return result;
+    }
+
+    void evaluate(const double* xs, const double* ys, const double* zs, double* out, size_t n) const {
+        int mx, my, mz;
+        maxPowers(mx, my, mz);
+        size_t rows = size_t(mx) + my + mz + 3;
+
+        //    9    
+        double local[3 * DensePolynomial::side * evalBlock];
+        vector<double> heap;
+        double* table = local;
+        if (rows > 3 * DensePolynomial::side) {
+            heap.resize(rows * evalBlock);
+            table = heap.data();
+        }
+        double* px = table;
+        double* py = px + (mx + 1) * evalBlock;
+        double* pz = py + (my + 1) * evalBlock;
+
+        for (size_t start = 0; start < n; start += evalBlock) {
+            size_t lanes = min(evalBlock, n - start);
+            fillPowers(xs + start, lanes, mx, px);
+            fillPowers(ys + start, lanes, my, py);
+            fillPowers(zs + start, lanes, mz, pz);
+
+            double acc[evalBlock] = {};
+            for (size_t t = 0; t < size(); ++t) {
+                Monomial m = Monomial::fromKey(0, keys[t]);
+                const double* a = px + m.getPowerX() * evalBlock;
+                const double* b = py + m.getPowerY() * evalBlock;
+                const double* c = pz + m.getPowerZ() * evalBlock;
+                double k = coeffs[t];
+                for (size_t l = 0; l < evalBlock; ++l) acc[l] += k * a[l] * b[l] * c[l];
+            }
+            copy(acc, acc + lanes, out + start);
+        }
+    }
+
+    //     (. EvaluationPlan)
+    EvaluationPlan compile() const;
+
+    void addTerm(const Monomial& m) {
+        append(m.getKey(), m.getCoefficient());
+        sortAndSimplify();
+    }
+
+    //     out:     
+    //  ,     ,   
+    void appendTo(string& out) const {
+        if (keys.empty()) {
+            out += '0';
+            return;
+        }
+        size_t start = out.size();
+        out.resize(start + size() * (Monomial::maxFormattedLength + 1));
+        char* begin = &out[start];
+        char* pos = begin;
+        for (size_t i = 0; i < size(); ++i) {
+            char* term = pos;
+            if (i > 0) *pos++ = '+';
+            char* end = Monomial::fromKey(coeffs[i], keys[i]).format(pos);
+            //      '-',     
+            if (i > 0 && *pos == '-') {
+                end = move(pos, end, term);
+            }
+            pos = end;
+        }
+        out.resize(start + (pos - begin));
+    }
+
+    //        
+    void write(FILE* file) const {
+        static thread_local string buffer;
+        buffer.clear();
+        appendTo(buffer);
+        if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+            throw runtime_error("Cannot write polynomial");
+        }
+    }
+
+    string toString() const {
+        string result;
+        appendTo(result);
+        return result;
+    }
+
+    TermsView getTerms() const { return TermsView(keys.data(), coeffs.data(), size()); }
+
+    //      (  ,   
+    // );      (nullptr -  )
+    static Polynomial fromTerms(vector<uint64_t> keys, vector<double> coeffs,
+                                ThreadPool* pool = nullptr) {
+        if (keys.size() != coeffs.size()) throw runtime_error("Invalid polynomial terms");
+        for (uint64_t key : keys) {
+            if (key >> (3 * Monomial::powerBits) != 0) throw runtime_error("Invalid polynomial terms");
+        }
+        Polynomial result;
+        result.keys = move(keys);
+        result.coeffs = move(coeffs);
+        result.sortAndSimplify(pool);
+        return result;
+    }
+
+    //        (  ,
+    //  )  ;    O(n)
+    static Polynomial fromCanonical(vector<uint64_t> keys, vector<double> coeffs) {
+        if (keys.size() != coeffs.size()) throw runtime_error("Invalid polynomial terms");
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (coeffs[i] == 0 || keys[i] >> (3 * Monomial::powerBits) != 0 ||
+                (i > 0 && keys[i - 1] <= keys[i])) {
+                throw runtime_error("Invalid polynomial terms");
+            }
+        }
+        Polynomial result;
+        result.keys = move(keys);
+        result.coeffs = move(coeffs);
+        return result;
+    }
+
+    friend ostream& operator<<(ostream& os, const Polynomial& p) {
+        os << p.toString();
+        return os;
+    }
+
+    friend istream& operator>>(istream& is, Polynomial& p) {
+        string input;
+        getline(is, input);
+        p.parse(input);
+        return is;
+    }
+
+    //    ;    
+    size_t hash() const {
+        uint64_t h = cachedHash.value.load(memory_order_relaxed);
+        if (h == 0) {
+            h = computeHash();
+            cachedHash.value.store(h, memory_order_relaxed);
+        }
+        return size_t(h);
+    }
+
+    //  ,   -  
+    // ;       
+    bool operator==(const Polynomial& other) const {
+        if (this == &other) return true;
+        if (size() != other.size() || hash() != other.hash()) return false;
+        return equal(keys.begin(), keys.end(), other.keys.begin()) &&
+            equal(coeffs.begin(), coeffs.end(), other.coeffs.begin());
+    }
+
+    bool operator!=(const Polynomial& other) const {
+        return !(*this == other);
+    }
+};
+
+namespace std {
+template <>
+struct hash<Polynomial> {
+    size_t operator()(const Polynomial& p) const { return p.hash(); }
+};
+}
+
+//    -   
+// P = sum x^a * (sum y^b * (sum c * z^e))   .
+//     -    ,  
+//   -   ;    
+// v^0..v^max,    
+class EvaluationPlan {
+private:
+    vector<double> coeffs;
+    vector<uint32_t> zStep;        //  
+    vector<uint32_t> yEnd, yStep;  //     x  y
+    vector<uint32_t> xEnd, xStep;  //     x
+    int maxX = 0, maxY = 0, maxZ = 0;
+
+    static constexpr size_t block = Polynomial::evalBlock;
+
+public:
+    EvaluationPlan() = default;
+
+    explicit EvaluationPlan(const Polynomial& p) {
+        size_t n = p.size();
+        p.maxPowers(maxX, maxY, maxZ);
+        coeffs.assign(p.coeffs.begin(), p.coeffs.end());
+        zStep.reserve(n);
+
+        for (size_t t = 0; t < n; ++t) {
+            Monomial m = Monomial::fromKey(0, p.keys[t]);
+            bool last = t + 1 == n;
+            Monomial next = Monomial::fromKey(0, last ? 0 : p.keys[t + 1]);
+            bool sameX = !last && next.getPowerX() == m.getPowerX();
+            bool sameY = sameX && next.getPowerY() == m.getPowerY();
+
+            zStep.push_back(sameY ? m.getPowerZ() - next.getPowerZ() : m.getPowerZ());
+            if (sameY) continue;
+            yEnd.push_back(uint32_t(t + 1));
+            yStep.push_back(sameX ? m.getPowerY() - next.getPowerY() : m.getPowerY());
+            if (sameX) continue;
+            xEnd.push_back(uint32_t(yEnd.size()));
+            xStep.push_back(last ? m.getPowerX() : m.getPowerX() - next.getPowerX());
+        }
+    }
+
+    size_t size() const { return coeffs.size(); }
+
+    double evaluate(double x, double y, double z) const {
+        size_t rows = size_t(maxX) + maxY + maxZ + 3;
+        double local[3 * DensePolynomial::side];
+        vector<double> heap;
+        double* xp = local;
+        if (rows > 3 * DensePolynomial::side) {
+            heap.resize(rows);
+            xp = heap.data();
+        }
+        double* yp = xp + maxX + 1;
+        double* zp = yp + maxY + 1;
+        xp[0] = yp[0] = zp[0] = 1;
+        for (int d = 1; d <= maxX; ++d) xp[d] = xp[d - 1] * x;
+        for (int d = 1; d <= maxY; ++d) yp[d] = yp[d - 1] * y;
+        for (int d = 1; d <= maxZ; ++d) zp[d] = zp[d - 1] * z;
+
+        double ax = 0;
+        size_t t = 0, g = 0;
+        for (size_t h = 0; h < xEnd.size(); ++h) {
+            double ay = 0;
+            for (; g < xEnd[h]; ++g) {
+                double az = 0;
+                for (; t < yEnd[g]; ++t) az = (az + coeffs[t]) * zp[zStep[t]];
+                ay = (ay + az) * yp[yStep[g]];
+            }
+            ax = (ax + ay) * xp[xStep[h]];
+        }
+        return ax;
+    }
+
+    //   ,   Polynomial::evaluate
+    void evaluate(const double* xs, const double* ys, const double* zs, double* out, size_t n) const {
+        size_t rows = size_t(maxX) + maxY + maxZ + 3;
+        double local[3 * DensePolynomial::side * block];
+        vector<double> heap;
+        double* table = local;
+        if (rows > 3 * DensePolynomial::side) {
+            heap.resize(rows * block);
+            table = heap.data();
+        }
+        double* px = table;
+        double* py = px + (maxX + 1) * block;
+        double* pz = py + (maxY + 1) * block;
+
+        for (size_t start = 0; start < n; start += block) {
+            size_t lanes = min(block, n - start);
+            Polynomial::fillPowers(xs + start, lanes, maxX, px);
+            Polynomial::fillPowers(ys + start, lanes, maxY, py);
+            Polynomial::fillPowers(zs + start, lanes, maxZ, pz);
+
+            double ax[block] = {};
+            size_t t = 0, g = 0;
+            for (size_t h = 0; h < xEnd.size(); ++h) {
+                double ay[block] = {};
+                for (; g < xEnd[h]; ++g) {
+                    double az[block] = {};
+                    for (; t < yEnd[g]; ++t) {
+                        double c = coeffs[t];
+                        const double* zp = pz + zStep[t] * block;
+                        for (size_t l = 0; l < block; ++l) az[l] = (az[l] + c) * zp[l];
+                    }
+                    const double* yp = py + yStep[g] * block;
+                    for (size_t l = 0; l < block; ++l) ay[l] = (ay[l] + az[l]) * yp[l];
+                }
+                const double* xp = px + xStep[h] * block;
+                for (size_t l = 0; l < block; ++l) ax[l] = (ax[l] + ay[l]) * xp[l];
+            }
+            copy(ax, ax + lanes, out + start);
+        }
+    }
+
+    //  :      parallelChunk,
+    //        out
+    static constexpr size_t parallelChunk = 4096;
+
+    void evaluate(const double* xs, const double* ys, const double* zs, double* out, size_t n,
+        ThreadPool& pool) const {
+        pool.parallelFor(n, parallelChunk, [&](size_t begin, size_t end) {
+            evaluate(xs + begin, ys + begin, zs + begin, out + begin, end - begin);
+        });
+    }
+};
+
+inline EvaluationPlan Polynomial::compile() const {
+    return EvaluationPlan(*this);
+}
+
+//   :     
+//    10x10x10;     9, 
+//    ,      
+class PolyAccumulator {
+private:
+    DensePolynomial dense;
+    Polynomial sparse;
+    bool isDense = true;
+
+    void push(uint64_t key, double coeff) {
+        if (isDense) {
+            if (DensePolynomial::fits(key)) {
+                dense.add(key, coeff);
+                return;
+            }
+            dense.forEachTerm([this](uint64_t k, double c) { sparse.append(k, c); });
+            isDense = false;
+        }
+        sparse.append(key, coeff);
+    }
+
+public:
+    void add(const Polynomial& p, double factor) {
+        if (factor == 0) return;
+        for (size_t i = 0; i < p.size(); ++i) push(p.keys[i], factor * p.coeffs[i]);
+    }
+
+    void addProduct(const Polynomial& a, const Polynomial& b, double factor) {
+        if (factor == 0 || a.keys.empty() || b.keys.empty()) return;
+        int ax, ay, az, bx, by, bz;
+        a.maxPowers(ax, ay, az);
+        b.maxPowers(bx, by, bz);
+        if (ax + bx > 9 || ay + by > 9 || az + bz > 9) {
+            throw runtime_error("Degree overflow");
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            double c = factor * a.coeffs[i];
+            for (size_t j = 0; j < b.size(); ++j) {
+                push(a.keys[i] + b.keys[j], c * b.coeffs[j]);
+            }
+        }
+    }
+
+    Polynomial result() {
+        if (isDense) return Polynomial(dense);
+        sparse.sortAndSimplify();
+        return move(sparse);
+    }
+};
+
+//  : lazy(p1) * p2 + p3 - lazy(p4) / 2.0  
+//        .
+// -        
+template <class E>
+class PolyExpr {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+
+    Polynomial evaluate() const {
+        PolyAccumulator acc;
+        self().accumulate(acc, 1);
+        return acc.result();
+    }
+};
+
+class PolyRef : public PolyExpr<PolyRef> {
+private:
+    const Polynomial& poly;
+
+public:
+    explicit PolyRef(const Polynomial& p) : poly(p) {}
+
+    const Polynomial& get() const { return poly; }
+
+    void accumulate(PolyAccumulator& acc, double factor) const {
+        acc.add(poly, factor);
+    }
+};
+
+inline PolyRef lazy(const Polynomial& p) {
+    return PolyRef(p);
+}
+
+//  :    ,  
+inline const Polynomial& operand(const PolyRef& ref) {
+    return ref.get();
+}
+
+template <class E>
+Polynomial operand(const PolyExpr<E>& expr) {
+    return expr.self().evaluate();
+}
+
+template <class L, class R>
+class PolySum : public PolyExpr<PolySum<L, R>> {
+private:
+    L left;
+    R right;
+    double sign;
+
+public:
+    PolySum(const L& l, const R& r, double s) : left(l), right(r), sign(s) {}
+
+    void accumulate(PolyAccumulator& acc, double factor) const {
+        left.accumulate(acc, factor);
+        right.accumulate(acc, sign * factor);
+    }
+};
+
+template <class L, class R>
+class PolyProduct : public PolyExpr<PolyProduct<L, R>> {
+private:
+    L left;
+    R right;
+
+public:
+    PolyProduct(const L& l, const R& r) : left(l), right(r) {}
+
+    void accumulate(PolyAccumulator& acc, double factor) const {
+        const auto& a = operand(left);
+        const auto& b = operand(right);
+        acc.addProduct(a, b, factor);
+    }
+};
+
+template <class E>
+class PolyScaled : public PolyExpr<PolyScaled<E>> {
+private:
+    E expr;
+    double scale;
+
+public:
+    PolyScaled(const E& e, double s) : expr(e), scale(s) {}
+
+    void accumulate(PolyAccumulator& acc, double factor) const {
+        expr.accumulate(acc, scale * factor);
+    }
+};
+
+template <class L, class R>
+PolySum<L, R> operator+(const PolyExpr<L>& l, const PolyExpr<R>& r) {
+    return PolySum<L, R>(l.self(), r.self(), 1);
+}
+
+template <class L>
+PolySum<L, PolyRef> operator+(const PolyExpr<L>& l, const Polynomial& r) {
+    return PolySum<L, PolyRef>(l.self(), PolyRef(r), 1);
+}
+
+template <class R>
+PolySum<PolyRef, R> operator+(const Polynomial& l, const PolyExpr<R>& r) {
+    return PolySum<PolyRef, R>(PolyRef(l), r.self(), 1);
+}
+
+template <class L, class R>
+PolySum<L, R> operator-(const PolyExpr<L>& l, const PolyExpr<R>& r) {
+    return PolySum<L, R>(l.self(), r.self(), -1);
+}
+
+template <class L>
+PolySum<L, PolyRef> operator-(const PolyExpr<L>& l, const Polynomial& r) {
+    return PolySum<L, PolyRef>(l.self(), PolyRef(r), -1);
+}
+
+template <class R>
+PolySum<PolyRef, R> operator-(const Polynomial& l, const PolyExpr<R>& r) {
+    return PolySum<PolyRef, R>(PolyRef(l), r.self(), -1);
+}
+
+template <class E>
+PolyScaled<E> operator-(const PolyExpr<E>& e) {
+    return PolyScaled<E>(e.self(), -1);
+}
+
+template <class L, class R>
+PolyProduct<L, R> operator*(const PolyExpr<L>& l, const PolyExpr<R>& r) {
+    return PolyProduct<L, R>(l.self(), r.self());
+}
+
+template <class L>
+PolyProduct<L, PolyRef> operator*(const PolyExpr<L>& l, const Polynomial& r) {
+    return PolyProduct<L, PolyRef>(l.self(), PolyRef(r));
+}
+
+template <class R>
+PolyProduct<PolyRef, R> operator*(const Polynomial& l, const PolyExpr<R>& r) {
+    return PolyProduct<PolyRef, R>(PolyRef(l), r.self());
+}
+
+template <class E>
+PolyScaled<E> operator*(const PolyExpr<E>& e, double scalar) {
+    return PolyScaled<E>(e.self(), scalar);
+}
+
+template <class E>
+PolyScaled<E> operator*(double scalar, const PolyExpr<E>& e) {
+    return PolyScaled<E>(e.self(), scalar);
+}
+
+template <class E>
+PolyScaled<E> operator/(const PolyExpr<E>& e, double divisor) {
+    if (divisor == 0) throw runtime_error("Division by zero");
+    return PolyScaled<E>(e.self(), 1 / divisor);
+}
+
+//   :  -     
+//  .   update  ,   
+//  (copy-on-write). intern      
+//     ,    
+//      
+class SharedPolynomial {
+private:
+    shared_ptr<Polynomial> ptr;
+    bool interned = false;
+
+    SharedPolynomial(shared_ptr<Polynomial> p, bool isInterned) : ptr(move(p)), interned(isInterned) {}
+
+    static const shared_ptr<Polynomial>& emptyBuffer() {
+        static const shared_ptr<Polynomial> empty = make_shared<Polynomial>();
+        return empty;
+    }
+
+    //  :  ->    .  
+    //      ,    
+    struct InternTable {
+        mutex lock;
+        unordered_multimap<size_t, weak_ptr<Polynomial>> entries;
+        size_t sweepAt = 64;
+    };
+
+    static InternTable& table() {
+        static InternTable instance;
+        return instance;
+    }
+
+public:
+    //  ;      
+    SharedPolynomial() : ptr(emptyBuffer()), interned(true) {}
+
+    SharedPolynomial(Polynomial p) : ptr(make_shared<Polynomial>(move(p))) {}
+
+    static SharedPolynomial intern(Polynomial p) {
+        if (p.getTerms().empty()) return SharedPolynomial();
+
+        size_t h = p.hash();
+        InternTable& t = table();
+        lock_guard<mutex> guard(t.lock);
+        auto range = t.entries.equal_range(h);
+        for (auto it = range.first; it != range.second;) {
+            shared_ptr<Polynomial> existing = it->second.lock();
+            if (!existing) {
+                it = t.entries.erase(it);
+                continue;
+            }
+            if (*existing == p) return SharedPolynomial(move(existing), true);
+            ++it;
+        }
+
+        if (t.entries.size() >= t.sweepAt) {
+            for (auto it = t.entries.begin(); it != t.entries.end();) {
+                if (it->second.expired()) it = t.entries.erase(it);
+                else ++it;
+            }
+            t.sweepAt = max<size_t>(64, 2 * t.entries.size());
+        }
+        auto buffer = make_shared<Polynomial>(move(p));
+        t.entries.emplace(h, buffer);
+        return SharedPolynomial(move(buffer), true);
+    }
+
+    SharedPolynomial intern() const {
+        return interned ? *this : intern(*ptr);
+    }
+
+    //      (    )
+    static size_t internTableSize() {
+        InternTable& t = table();
+        lock_guard<mutex> guard(t.lock);
+        return t.entries.size();
+    }
+
+    const Polynomial& get() const { return *ptr; }
+    const Polynomial& operator*() const { return *ptr; }
+    const Polynomial* operator->() const { return ptr.get(); }
+
+    bool isInterned() const { return interned; }
+    bool sharesBufferWith(const SharedPolynomial& other) const { return ptr == other.ptr; }
+
+    //   ,      ;
+    //  (   )   
+    template <class F>
+    SharedPolynomial& update(F f) {
+        if (interned || ptr.use_count() != 1) {
+            ptr = make_shared<Polynomial>(*ptr);
+            interned = false;
+        }
+        f(*ptr);
+        return *this;
+    }
+
+    SharedPolynomial& operator+=(const SharedPolynomial& other) {
+        return update([&other](Polynomial& p) { p += *other; });
+    }
+
+    SharedPolynomial& operator-=(const SharedPolynomial& other) {
+        return update([&other](Polynomial& p) { p -= *other; });
+    }
+
+    SharedPolynomial& operator*=(const SharedPolynomial& other) {
+        Polynomial product = *ptr * *other;
+        return update([&product](Polynomial& p) { p = move(product); });
+    }
+
+    friend SharedPolynomial operator+(const SharedPolynomial& a, const SharedPolynomial& b) { return *a + *b; }
+    friend SharedPolynomial operator-(const SharedPolynomial& a, const SharedPolynomial& b) { return *a - *b; }
+    friend SharedPolynomial operator*(const SharedPolynomial& a, const SharedPolynomial& b) { return *a * *b; }
+
+    bool operator==(const SharedPolynomial& other) const {
+        if (ptr == other.ptr) return true;
+        if (interned && other.interned) return false;
+        return *ptr == *other.ptr;
+    }
+
+    bool operator!=(const SharedPolynomial& other) const {
+        return !(*this == other);
+    }
+
+    size_t hash() const { return ptr->hash(); }
+
+    friend ostream& operator<<(ostream& os, const SharedPolynomial& p) {
+        return os << *p;
+    }
+};
+
+namespace std {
+template <>
+struct hash<SharedPolynomial> {
+    size_t operator()(const SharedPolynomial& p) const { return p.hash(); }
+};
+}
+
+//    (     ,  
+//    8 ,       ):
+//   SnapshotHeader
+//      : uint64  , uint64  ,
+//      (   8 ), uint64 [], double []
+//   : uint64       ( indexOffset)
+struct SnapshotHeader {
+    static constexpr char expectedMagic[8] = { 'P', 'O', 'L', 'Y', 'S', 'N', 'A', 'P' };
+    static constexpr uint32_t currentVersion = 1;
+    static constexpr uint32_t byteOrderTag = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t count;
+    uint64_t indexOffset;
+
+    static size_t padded(size_t n) { return (n + 7) & ~size_t(7); }
+
+    void validate() const {
+        if (!equal(magic, magic + 8, expectedMagic)) throw runtime_error("Not a polynomial snapshot");
+        if (version != currentVersion) throw runtime_error("Unsupported snapshot version");
+        if (byteOrder != byteOrderTag) throw runtime_error("Snapshot byte order mismatch");
+    }
+};
+
+static_assert(sizeof(SnapshotHeader) == 32, "Snapshot header layout");
+
+//      (fsync / FlushFileBuffers)
+inline void syncFileToDisk(const string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw runtime_error("Cannot open for sync: " + path);
+    bool ok = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw runtime_error("Cannot open for sync: " + path);
+    bool ok = fsync(fd) == 0;
+    ::close(fd);
+#endif
+    if (!ok) throw runtime_error("Cannot sync: " + path);
+}
+
+//  ,    path,    
+// .  Windows MoveFileEx  MOVEFILE_WRITE_THROUGH   
+inline void syncParentDirectory(const string& path) {
+#ifndef _WIN32
+    size_t slash = path.find_last_of('/');
+    string dir = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd < 0) throw runtime_error("Cannot open directory for sync: " + dir);
+    bool ok = fsync(fd) == 0;
+    ::close(fd);
+    if (!ok) throw runtime_error("Cannot sync directory: " + dir);
+#else
+    (void)path;
+#endif
+}
+
+//    (write-ahead log). : 8  "POLYLOG1",
+//  : uint8 , uint32  , uint32  ,
+// , uint64 [], double [], uint64  
+// (FNV-1a    ).    ,
+//         .
+//  :    ,   write + fsync
+//     ( groupSize    sync);
+// ,    ,    fsync
+class StorageLog {
+public:
+    enum Operation : uint8_t { Assign = 1, Erase = 2 };
+
+private:
+    static constexpr char magic[8] = { 'P', 'O', 'L', 'Y', 'L', 'O', 'G', '1' };
+
+    int fd = -1;
+    size_t groupSize;
+    mutex lock;
+    condition_variable flushed;
+    string pending;             // ,     
+    uint64_t appended = 0;      //    
+    uint64_t durable = 0;       //   ,  fsync
+    bool flushing = false;
+    bool failed = false;
+
+    static uint64_t checksum(const char* data, size_t n) {
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < n; ++i) {
+            h ^= uint8_t(data[i]);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    template<class T>
+    static void put(string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static void encode(string& out, Operation op, const string& name, TermsView terms) {
+        size_t start = out.size();
+        put(out, uint8_t(op));
+        put(out, uint32_t(name.size()));
+        put(out, uint32_t(terms.size()));
+        out += name;
+        if (!terms.empty()) {
+            out.append(reinterpret_cast<const char*>(terms.keys()), terms.size() * sizeof(uint64_t));
+            out.append(reinterpret_cast<const char*>(terms.coefficients()), terms.size() * sizeof(double));
+        }
+        put(out, checksum(out.data() + start, out.size() - start));
+    }
+
+    void writeAll(const char* data, size_t n) {
+        while (n > 0) {
+#ifdef _WIN32
+            int written = _write(fd, data, unsigned(min<size_t>(n, 1u << 30)));
+#else
+            ssize_t written = ::write(fd, data, n);
+#endif
+            if (written <= 0) throw runtime_error("Cannot write storage log");
+            data += written;
+            n -= size_t(written);
+        }
+    }
+
+    void syncFile() {
+#ifdef _WIN32
+        if (_commit(fd) != 0) throw runtime_error("Cannot sync storage log");
+#else
+        if (fsync(fd) != 0) throw runtime_error("Cannot sync storage log");
+#endif
+    }
+
+    void truncateFile(uint64_t size) {
+#ifdef _WIN32
+        if (_chsize_s(fd, int64_t(size)) != 0) throw runtime_error("Cannot truncate storage log");
+        _lseeki64(fd, 0, SEEK_END);
+#else
+        if (ftruncate(fd, off_t(size)) != 0) throw runtime_error("Cannot truncate storage log");
+        lseek(fd, 0, SEEK_END);
+#endif
+    }
+
+    uint64_t append(Operation op, const string& name, TermsView terms) {
+        uint64_t seq;
+        {
+            lock_guard<mutex> guard(lock);
+            if (failed) throw runtime_error("Storage log is unusable after a write error");
+            encode(pending, op, name, terms);
+            seq = ++appended;
+        }
+        if (seq % groupSize == 0) commit(seq);
+        return seq;
+    }
+
+public:
+    //    ;     .
+    //        ,   
+    //  (). groupSize = 1 - fsync   
+    explicit StorageLog(const string& path, size_t groupSize = 64)
+        : groupSize(max<size_t>(1, groupSize)) {
+        uint64_t valid = replay(path, nullptr);
+#ifdef _WIN32
+        fd = _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+#endif
+        if (fd < 0) throw runtime_error("Cannot open storage log: " + path);
+        try {
+            truncateFile(valid);
+            if (valid == 0) {
+                writeAll(magic, sizeof(magic));
+                syncFile();
+            }
+        }
+        catch (...) {
+#ifdef _WIN32
+            _close(fd);
+#else
+            ::close(fd);
+#endif
+            throw;
+        }
+    }
+
+    StorageLog(const StorageLog&) = delete;
+    StorageLog& operator=(const StorageLog&) = delete;
+
+    ~StorageLog() {
+        try {
+            sync();
+        }
+        catch (...) {
+        }
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    uint64_t logAssign(const string& name, const Polynomial& poly) {
+        return append(Assign, name, poly.getTerms());
+    }
+
+    uint64_t logErase(const string& name) {
+        return append(Erase, name, TermsView(nullptr, nullptr, 0));
+    }
+
+    // ,   seq    .   
+    //    ,    
+    void commit(uint64_t seq) {
+        unique_lock<mutex> guard(lock);
+        while (durable < seq) {
+            if (failed) throw runtime_error("Storage log is unusable after a write error");
+            if (flushing) {
+                flushed.wait(guard);
+                continue;
+            }
+            flushing = true;
+            string batch;
+            batch.swap(pending);
+            uint64_t upTo = appended;
+            guard.unlock();
+            bool ok = true;
+            try {
+                writeAll(batch.data(), batch.size());
+                syncFile();
+            }
+            catch (...) {
+                ok = false;
+            }
+            guard.lock();
+            flushing = false;
+            if (ok) durable = upTo;
+            else failed = true;
+            flushed.notify_all();
+        }
+    }
+
+    void sync() {
+        uint64_t seq;
+        {
+            lock_guard<mutex> guard(lock);
+            seq = appended;
+        }
+        commit(seq);
+    }
+
+    //    ,      
+    void reset() {
+        sync();
+        lock_guard<mutex> guard(lock);
+        truncateFile(sizeof(magic));
+        syncFile();
+    }
+
+    //     ;   
+    //    .     :
+    // 0,   ,       .
+    //      - 
+    static uint64_t replay(const string& path,
+                           const function<void(Operation, const string&, Polynomial)>& apply) {
+        ifstream in(path, ios::binary);
+        if (!in) return 0;
+        string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        if (data.size() < sizeof(magic)) {
+            if (equal(data.begin(), data.end(), magic)) return 0;
+            throw runtime_error("Not a storage log: " + path);
+        }
+        if (!equal(magic, magic + sizeof(magic), data.begin())) throw runtime_error("Not a storage log: " + path);
+
+        size_t pos = sizeof(magic);
+        const size_t fixed = sizeof(uint8_t) + 2 * sizeof(uint32_t);
+        while (data.size() - pos >= fixed + sizeof(uint64_t)) {
+            const char* record = data.data() + pos;
+            uint8_t op;
+            uint32_t nameLength, termCount;
+            memcpy(&op, record, sizeof(op));
+            memcpy(&nameLength, record + 1, sizeof(nameLength));
+            memcpy(&termCount, record + 5, sizeof(termCount));
+            uint64_t body = fixed + uint64_t(nameLength) + 16 * uint64_t(termCount);
+            if (data.size() - pos - sizeof(uint64_t) < body) break;
+            uint64_t stored;
+            memcpy(&stored, record + body, sizeof(stored));
+            if (stored != checksum(record, body) || (op != Assign && op != Erase)) break;
+
+            if (apply) {
+                string name(record + fixed, nameLength);
+                vector<uint64_t> keys(termCount);
+                vector<double> coeffs(termCount);
+                if (termCount > 0) {
+                    memcpy(keys.data(), record + fixed + nameLength, termCount * sizeof(uint64_t));
+                    memcpy(coeffs.data(), record + fixed + nameLength + termCount * sizeof(uint64_t),
+                           termCount * sizeof(double));
+                }
+                apply(Operation(op), name, Polynomial::fromCanonical(move(keys), move(coeffs)));
+            }
+            pos += body + sizeof(uint64_t);
+        }
+        return pos;
+    }
+};
+
+//    .  :  
+//   (Id),       O(1) 
+//  .   - -    
+//  ;     ,  
+//    erase
+class PolynomialStorage {
+public:
+    using Id = uint32_t;
+    static constexpr Id npos = UINT32_MAX;
+    //  ,   list    
+    static constexpr size_t listFlushSize = 1 << 16;
+
+private:
+    vector<string> names;        // Id -> 
+    vector<size_t> nameHashes;   // Id ->   (  )
+    deque<Polynomial> values;    // Id -> ; deque   
+                                 //  ,   get  
+    vector<char> present;        // Id ->   
+    vector<Id> table;            //  , npos - 
+    size_t count = 0;
+    StorageLog* log = nullptr;   //  ,  
+    uint64_t lastLogged = 0;     //       
+
+    //           
+    size_t probe(const string& name, size_t h) const {
+        size_t mask = table.size() - 1;
+        for (size_t slot = h & mask;; slot = (slot + 1) & mask) {
+            Id id = table[slot];
+            if (id == npos || (nameHashes[id] == h && names[id] == name)) return slot;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        table.assign(capacity, npos);
+        size_t mask = capacity - 1;
+        for (Id id = 0; id < names.size(); ++id) {
+            size_t slot = nameHashes[id] & mask;
+            while (table[slot] != npos) slot = (slot + 1) & mask;
+            table[slot] = id;
+        }
+    }
+
+    Id checked(Id id) const {
+        if (id >= names.size() || !present[id]) throw runtime_error("  ");
+        return id;
+    }
+
+    void copyContents(const PolynomialStorage& other) {
+        names = other.names;
+        nameHashes = other.nameHashes;
+        values = other.values;
+        present = other.present;
+        table = other.table;
+        count = other.count;
+    }
+
+public:
+    PolynomialStorage() = default;
+
+    //  -    :    
+    //    .     
+    //  ,     
+    PolynomialStorage(const PolynomialStorage& other) {
+        copyContents(other);
+    }
+
+    PolynomialStorage& operator=(const PolynomialStorage& other) {
+        if (this != &other) {
+            copyContents(other);
+            log = nullptr;
+            lastLogged = 0;
+        }
+        return *this;
+    }
+
+    PolynomialStorage(PolynomialStorage&& other) noexcept
+        : names(move(other.names)), nameHashes(move(other.nameHashes)), values(move(other.values)),
+          present(move(other.present)), table(move(other.table)), count(other.count),
+          log(other.log), lastLogged(other.lastLogged) {
+        other.log = nullptr;
+        other.lastLogged = 0;
+    }
+
+    PolynomialStorage& operator=(PolynomialStorage&& other) noexcept {
+        if (this != &other) {
+            names = move(other.names);
+            nameHashes = move(other.nameHashes);
+            values = move(other.values);
+            present = move(other.present);
+            table = move(other.table);
+            count = other.count;
+            log = other.log;
+            lastLogged = other.lastLogged;
+            other.log = nullptr;
+            other.lastLogged = 0;
+        }
+        return *this;
+    }
+
+    //    npos,    
+    Id find(const string& name) const {
+        if (table.empty()) return npos;
+        return table[probe(name, hash<string>()(name))];
+    }
+
+    //  ;    ( )
+    Id intern(const string& name) {
+        //     
+        if (2 * (names.size() + 1) > table.size()) rehash(max<size_t>(16, 2 * table.size()));
+        size_t h = hash<string>()(name);
+        size_t slot = probe(name, h);
+        if (table[slot] != npos) return table[slot];
+
+        Id id = Id(names.size());
+        names.push_back(name);
+        nameHashes.push_back(h);
+        values.emplace_back();
+        present.push_back(0);
+        table[slot] = id;
+        return id;
+    }
+
+    // second == true,       
+    pair<Id, bool> insert_or_assign(const string& name, Polynomial poly) {
+        if (log) lastLogged = log->logAssign(name, poly);
+        Id id = intern(name);
+        bool inserted = !present[id];
+        values[id] = move(poly);
+        present[id] = 1;
+        count += inserted;
+        return make_pair(id, inserted);
+    }
+
+    //    
+    pair<Id, bool> try_insert(const string& name, Polynomial poly) {
+        Id id = intern(name);
+        if (present[id]) return make_pair(id, false);
+        if (log) lastLogged = log->logAssign(name, poly);
+        values[id] = move(poly);
+        present[id] = 1;
+        ++count;
+        return make_pair(id, true);
+    }
+
+    bool erase(Id id) {
+        if (id >= names.size() || !present[id]) return false;
+        if (log) lastLogged = log->logErase(names[id]);
+        values[id] = Polynomial();
+        present[id] = 0;
+        --count;
+        return true;
+    }
+
+    bool erase(const string& name) { return erase(find(name)); }
+
+    bool contains(Id id) const { return id < names.size() && present[id]; }
+    bool contains(const string& name) const { return contains(find(name)); }
+
+    size_t size() const { return count; }
+
+    const string& name(Id id) const {
+        if (id >= names.size()) throw runtime_error("  ");
+        return names[id];
+    }
+
+    const Polynomial& get(Id id) const { return values[checked(id)]; }
+    const Polynomial& get(const string& name) const { return get(find(name)); }
+
+    //      
+    vector<Id> sortedIds() const {
+        vector<Id> ids;
+        ids.reserve(count);
+        for (Id id = 0; id < names.size(); ++id) {
+            if (present[id]) ids.push_back(id);
+        }
+        sort(ids.begin(), ids.end(), [this](Id a, Id b) { return names[a] < names[b]; });
+        return ids;
+    }
+
+    //     (. SnapshotHeader)
+    void save(const string& path) const {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out) throw runtime_error("Cannot open snapshot for writing: " + path);
+
+        vector<Id> ids = sortedIds();
+        vector<uint64_t> offsets;
+        offsets.reserve(ids.size());
+        uint64_t offset = sizeof(SnapshotHeader);
+        for (Id id : ids) {
+            offsets.push_back(offset);
+            offset += 16 + SnapshotHeader::padded(names[id].size()) + 16 * values[id].getTerms().size();
+        }
+
+        SnapshotHeader header;
+        copy(SnapshotHeader::expectedMagic, SnapshotHeader::expectedMagic + 8, header.magic);
+        header.version = SnapshotHeader::currentVersion;
+        header.byteOrder = SnapshotHeader::byteOrderTag;
+        header.count = ids.size();
+        header.indexOffset = offset;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        const char zeros[8] = {};
+        for (Id id : ids) {
+            TermsView terms = values[id].getTerms();
+            uint64_t sizes[2] = { names[id].size(), terms.size() };
+            out.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+            out.write(names[id].data(), names[id].size());
+            out.write(zeros, SnapshotHeader::padded(names[id].size()) - names[id].size());
+            out.write(reinterpret_cast<const char*>(terms.keys()), terms.size() * sizeof(uint64_t));
+            out.write(reinterpret_cast<const char*>(terms.coefficients()), terms.size() * sizeof(double));
+        }
+        out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        if (!out.flush()) throw runtime_error("Cannot write snapshot: " + path);
+    }
+
+    //     :   
+    //    ,     
+    void load(const string& path) {
+        ifstream in(path, ios::binary);
+        if (!in) throw runtime_error("Cannot open snapshot: " + path);
+        auto read = [&in](void* dst, size_t bytes) {
+            if (!in.read(static_cast<char*>(dst), bytes)) throw runtime_error("Truncated snapshot");
+        };
+
+        in.seekg(0, ios::end);
+        uint64_t length = uint64_t(in.tellg());
+        in.seekg(0, ios::beg);
+
+        SnapshotHeader header;
+        read(&header, sizeof(header));
+        header.validate();
+        if (header.indexOffset < sizeof(header) || header.indexOffset > length ||
+            header.count > (length - header.indexOffset) / sizeof(uint64_t)) {
+            throw runtime_error("Corrupt snapshot");
+        }
+
+        //      ,   ,
+        //      
+        PolynomialStorage loaded;
+        uint64_t offset = sizeof(header);
+        for (uint64_t i = 0; i < header.count; ++i) {
+            uint64_t sizes[2];
+            if (header.indexOffset - offset < sizeof(sizes)) throw runtime_error("Corrupt snapshot");
+            read(sizes, sizeof(sizes));
+            uint64_t available = header.indexOffset - offset - sizeof(sizes);
+            if (sizes[0] > available || SnapshotHeader::padded(sizes[0]) > available ||
+                sizes[1] > (available - SnapshotHeader::padded(sizes[0])) / 16) {
+                throw runtime_error("Corrupt snapshot");
+            }
+            offset += sizeof(sizes) + SnapshotHeader::padded(sizes[0]) + 16 * sizes[1];
+
+            string name(SnapshotHeader::padded(sizes[0]), '\0');
+            read(&name[0], name.size());
+            name.resize(sizes[0]);
+            vector<uint64_t> keys(sizes[1]);
+            vector<double> coeffs(sizes[1]);
+            read(keys.data(), keys.size() * sizeof(uint64_t));
+            read(coeffs.data(), coeffs.size() * sizeof(double));
+            loaded.insert_or_assign(name, Polynomial::fromCanonical(move(keys), move(coeffs)));
+        }
+        loaded.log = log;
+        loaded.lastLogged = lastLogged;
+        *this = move(loaded);
+    }
+
+    //  :       .
+    // nullptr  .     .
+    //  ,      :  
+    //     groupSize- ,  syncLog  sync
+    // ,        groupSize - 1 
+    // .      - groupSize = 1
+    void attachLog(StorageLog* newLog) {
+        log = newLog;
+        lastLogged = 0;
+    }
+
+    // ,           
+    void syncLog() {
+        if (log) log->commit(lastLogged);
+    }
+
+    //   :   (  )  
+    //     
+    void recover(const string& snapshotPath, const string& logPath) {
+        PolynomialStorage recovered;
+        if (ifstream(snapshotPath, ios::binary)) recovered.load(snapshotPath);
+        StorageLog::replay(logPath, [&recovered](StorageLog::Operation op, const string& name, Polynomial poly) {
+            if (op == StorageLog::Assign) recovered.insert_or_assign(name, move(poly));
+            else recovered.erase(name);
+        });
+        recovered.log = log;
+        recovered.lastLogged = lastLogged;
+        *this = move(recovered);
+    }
+
+    //     .      
+    //   ,      
+    //     + 
+    //  ,     ,      
+    void checkpoint(const string& snapshotPath) {
+        if (log) log->sync();
+        string temporary = snapshotPath + ".tmp";
+        save(temporary);
+        syncFileToDisk(temporary);
+#ifdef _WIN32
+        bool renamed = MoveFileExA(temporary.c_str(), snapshotPath.c_str(),
+                                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        bool renamed = rename(temporary.c_str(), snapshotPath.c_str()) == 0;
+#endif
+        if (!renamed) throw runtime_error("Cannot replace snapshot: " + snapshotPath);
+        syncParentDirectory(snapshotPath);
+        if (log) log->reset();
+    }
+
+    //         
+    void list(ostream& os = cout) const {
+        if (count == 0) {
+            os << "  .\n";
+            return;
+        }
+        string buffer = " :\n";
+        for (Id id : sortedIds()) {
+            buffer += "  ";
+            buffer += names[id];
+            buffer += " = ";
+            values[id].appendTo(buffer);
+            buffer += '\n';
+            if (buffer.size() >= listFlushSize) {
+                os.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        os.write(buffer.data(), buffer.size());
+    }
+};
+
+//      ,   
+// (mmap / MapViewOfFile).    ,    -
+//     , get  TermsView   
+//   .     , 
+//     .  ,   
+class MappedPolynomialStorage {
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    const uint64_t* offsets = nullptr;
+    size_t count = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    struct Record {
+        string_view name;
+        TermsView terms;
+    };
+
+    void map(const string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw runtime_error("Cannot open snapshot: " + path);
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) throw runtime_error("Cannot stat snapshot: " + path);
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length < sizeof(SnapshotHeader)) throw runtime_error("Truncated snapshot");
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) throw runtime_error("Cannot map snapshot: " + path);
+        base = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!base) throw runtime_error("Cannot map snapshot: " + path);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("Cannot open snapshot: " + path);
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw runtime_error("Cannot stat snapshot: " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            throw runtime_error("Truncated snapshot");
+        }
+        void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) throw runtime_error("Cannot map snapshot: " + path);
+        base = static_cast<const char*>(addr);
+#endif
+    }
+
+    void unmap() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(const_cast<char*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+        offsets = nullptr;
+        count = 0;
+    }
+
+    //     ;     ,
+    //      
+    Record record(size_t i) const {
+        uint64_t offset = offsets[i];
+        if (offset % 8 != 0 || offset > length || length - offset < 16) {
+            throw runtime_error("Corrupt snapshot");
+        }
+        const uint64_t* sizes = reinterpret_cast<const uint64_t*>(base + offset);
+        uint64_t nameLength = sizes[0], termCount = sizes[1];
+        uint64_t available = length - offset - 16;
+        //       8,   
+        //   ,    
+        if (nameLength > available || SnapshotHeader::padded(nameLength) > available ||
+            termCount > (available - SnapshotHeader::padded(nameLength)) / 16) {
+            throw runtime_error("Corrupt snapshot");
+        }
+        const char* name = base + offset + 16;
+        const char* terms = name + SnapshotHeader::padded(nameLength);
+        return { string_view(name, nameLength),
+                 TermsView(reinterpret_cast<const uint64_t*>(terms),
+                           reinterpret_cast<const double*>(terms + termCount * sizeof(uint64_t)),
+                           termCount) };
+    }
+
+    size_t lowerBound(string_view name) const {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (record(mid).name < name) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+public:
+    MappedPolynomialStorage() = default;
+
+    explicit MappedPolynomialStorage(const string& path) {
+        open(path);
+    }
+
+    MappedPolynomialStorage(const MappedPolynomialStorage&) = delete;
+    MappedPolynomialStorage& operator=(const MappedPolynomialStorage&) = delete;
+
+    MappedPolynomialStorage(MappedPolynomialStorage&& other) noexcept {
+        *this = move(other);
+    }
+
+    MappedPolynomialStorage& operator=(MappedPolynomialStorage&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            swap(base, other.base);
+            swap(length, other.length);
+            swap(offsets, other.offsets);
+            swap(count, other.count);
+#ifdef _WIN32
+            swap(file, other.file);
+            swap(mapping, other.mapping);
+#endif
+        }
+        return *this;
+    }
+
+    ~MappedPolynomialStorage() {
+        unmap();
+    }
+
+    void open(const string& path) {
+        close();
+        try {
+            map(path);
+            const SnapshotHeader& header = *reinterpret_cast<const SnapshotHeader*>(base);
+            header.validate();
+            if (header.indexOffset % 8 != 0 || header.indexOffset > length ||
+                header.count > (length - header.indexOffset) / sizeof(uint64_t)) {
+                throw runtime_error("Corrupt snapshot");
+            }
+            offsets = reinterpret_cast<const uint64_t*>(base + header.indexOffset);
+            count = header.count;
+        }
+        catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    void close() {
+        unmap();
+    }
+
+    bool isOpen() const {
+        return base != nullptr;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool contains(string_view name) const {
+        size_t i = lowerBound(name);
+        return i < count && record(i).name == name;
+    }
+
+    //    ; Polynomial::fromCanonical  
+    TermsView get(string_view name) const {
+        size_t i = lowerBound(name);
+        if (i == count) throw runtime_error("  ");
+        Record r = record(i);
+        if (r.name != name) throw runtime_error("  ");
+        return r.terms;
+    }
+
+    Polynomial copy(string_view name) const {
+        TermsView terms = get(name);
+        return Polynomial::fromCanonical(vector<uint64_t>(terms.keys(), terms.keys() + terms.size()),
+                                         vector<double>(terms.coefficients(), terms.coefficients() + terms.size()));
+    }
+
+    //     
+    vector<string_view> names() const {
+        vector<string_view> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i) result.push_back(record(i).name);
+        return result;
+    }
+};
+
+//  :    shardCount , 
+//   shared_mutex.     
+// : get    ,   ,
+//      
+class ConcurrentPolynomialStorage {
+public:
+    using Handle = shared_ptr<const Polynomial>;
+    static constexpr size_t shardCount = 64;
+
+private:
+    struct Shard {
+        mutable shared_mutex lock;
+        unordered_map<string, Handle> entries;
+    };
+
+    array<Shard, shardCount> shards;
+
+    Shard& shardFor(const string& name) { return shards[hash<string>()(name) % shardCount]; }
+    const Shard& shardFor(const string& name) const { return shards[hash<string>()(name) % shardCount]; }
+
+public:
+    // true,    
+    bool insert_or_assign(const string& name, Polynomial poly) {
+        Handle handle = make_shared<const Polynomial>(move(poly));
+        Shard& shard = shardFor(name);
+        unique_lock<shared_mutex> guard(shard.lock);
+        auto result = shard.entries.insert_or_assign(name, move(handle));
+        return result.second;
+    }
+
+    //    
+    bool try_insert(const string& name, Polynomial poly) {
+        Shard& shard = shardFor(name);
+        {
+            shared_lock<shared_mutex> guard(shard.lock);
+            if (shard.entries.count(name)) return false;
+        }
+        Handle handle = make_shared<const Polynomial>(move(poly));
+        unique_lock<shared_mutex> guard(shard.lock);
+        return shard.entries.try_emplace(name, move(handle)).second;
+    }
+
+    bool erase(const string& name) {
+        Shard& shard = shardFor(name);
+        unique_lock<shared_mutex> guard(shard.lock);
+        return shard.entries.erase(name) > 0;
+    }
+
+    // nullptr,   
+    Handle find(const string& name) const {
+        const Shard& shard = shardFor(name);
+        shared_lock<shared_mutex> guard(shard.lock);
+        auto it = shard.entries.find(name);
+        return it == shard.entries.end() ? nullptr : it->second;
+    }
+
+    Handle get(const string& name) const {
+        Handle handle = find(name);
+        if (!handle) throw runtime_error("  ");
+        return handle;
+    }
+
+    bool contains(const string& name) const { return find(name) != nullptr; }
+
+    //  : f()    
+    // ,        ; 
+    //  .   
+    template <class F>
+    Handle update(const string& name, F f) {
+        Shard& shard = shardFor(name);
+        while (true) {
+            Handle current = get(name);
+            Handle next = make_shared<const Polynomial>(f(*current));
+            unique_lock<shared_mutex> guard(shard.lock);
+            auto it = shard.entries.find(name);
+            if (it == shard.entries.end()) throw runtime_error("  ");
+            if (it->second == current) {
+                it->second = next;
+                return next;
+            }
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& shard : shards) {
+            shared_lock<shared_mutex> guard(shard.lock);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+
+    //     ,   
+    vector<pair<string, Handle>> snapshot() const {
+        vector<pair<string, Handle>> entries;
+        for (const auto& shard : shards) {
+            shared_lock<shared_mutex> guard(shard.lock);
+            entries.insert(entries.end(), shard.entries.begin(), shard.entries.end());
+        }
+        sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        return entries;
+    }
+};
+
+//     :  -   
+//    .     
+// ,      
+class PolynomialGraph {
+public:
+    using Node = size_t;
+
+private:
+    enum class Op { Input, Add, Sub, Mul, Div };
+
+    struct NodeInfo {
+        Op op;
+        Node left, right;
+        double scalar;
+        string name;
+    };
+
+    vector<NodeInfo> nodes;
+    map<tuple<Op, Node, Node, double, string>, Node> known;
+    vector<pair<string, Node>> outputs;
+
+    Node intern(Op op, Node left, Node right, double scalar, const string& name) {
+        if (op != Op::Input && (left >= nodes.size() || right >= nodes.size())) {
+            throw runtime_error("Unknown graph node");
+        }
+        //    :    
+        if ((op == Op::Add || op == Op::Mul) && right < left) swap(left, right);
+        auto key = make_tuple(op, left, right, scalar, name);
+        auto it = known.find(key);
+        if (it != known.end()) return it->second;
+        nodes.push_back({ op, left, right, scalar, name });
+        known.emplace(key, nodes.size() - 1);
+        return nodes.size() - 1;
+    }
+
+public:
+    Node input(const string& name) { return intern(Op::Input, 0, 0, 0, name); }
+    Node add(Node a, Node b) { return intern(Op::Add, a, b, 0, ""); }
+    Node sub(Node a, Node b) { return intern(Op::Sub, a, b, 0, ""); }
+    Node mul(Node a, Node b) { return intern(Op::Mul, a, b, 0, ""); }
+
+    Node divide(Node a, double divisor) {
+        if (divisor == 0) throw runtime_error("Division by zero");
+        return intern(Op::Div, a, a, divisor, "");
+    }
+
+    void output(const string& name, Node node) {
+        if (node >= nodes.size()) throw runtime_error("Unknown graph node");
+        outputs.emplace_back(name, node);
+    }
+
+    size_t size() const { return nodes.size(); }
+
+    // :    ,     ;
+    //      .
+    //   ,      
+    map<string, Polynomial> run(const PolynomialStorage& storage, ThreadPool& pool = ThreadPool::shared()) const {
+        size_t n = nodes.size();
+        vector<char> needed(n, 0);
+        for (const auto& out : outputs) needed[out.second] = 1;
+        for (size_t i = n; i-- > 0;) {
+            if (!needed[i] || nodes[i].op == Op::Input) continue;
+            needed[nodes[i].left] = needed[nodes[i].right] = 1;
+        }
+
+        struct State {
+            vector<Polynomial> values;
+            vector<vector<Node>> dependents;
+            unique_ptr<atomic<int>[]> waiting, consumers;
+            vector<char> keep;
+            size_t remaining = 0;
+            atomic<bool> failed{ false };
+            exception_ptr error;
+            mutex lock;
+            condition_variable done;
+        } state;
+        state.values.resize(n);
+        state.dependents.resize(n);
+        state.waiting.reset(new atomic<int>[n]);
+        state.consumers.reset(new atomic<int>[n]);
+        state.keep.assign(n, 0);
+        for (const auto& out : outputs) state.keep[out.second] = 1;
+
+        vector<Node> ready;
+        for (Node i = 0; i < n; ++i) {
+            state.waiting[i] = 0;
+            state.consumers[i] = 0;
+        }
+        for (Node i = 0; i < n; ++i) {
+            if (!needed[i]) continue;
+            ++state.remaining;
+            const NodeInfo& node = nodes[i];
+            if (node.op == Op::Input) {
+                ready.push_back(i);
+                continue;
+            }
+            Node operands[2] = { node.left, node.right };
+            size_t count = node.left == node.right ? 1 : 2;
+            for (size_t k = 0; k < count; ++k) {
+                state.dependents[operands[k]].push_back(i);
+                ++state.waiting[i];
+                ++state.consumers[operands[k]];
+            }
+        }
+
+        function<void(Node)> execute = [&](Node i) {
+            const NodeInfo& node = nodes[i];
+            if (!state.failed) {
+                try {
+                    const vector<Polynomial>& v = state.values;
+                    switch (node.op) {
+                    case Op::Input: state.values[i] = storage.get(node.name); break;
+                    case Op::Add: state.values[i] = v[node.left] + v[node.right]; break;
+                    case Op::Sub: state.values[i] = v[node.left] - v[node.right]; break;
+                    case Op::Mul: state.values[i] = v[node.left] * v[node.right]; break;
+                    case Op::Div: state.values[i] = v[node.left] / node.scalar; break;
+                    }
+                }
+                catch (...) {
+                    lock_guard<mutex> guard(state.lock);
+                    if (!state.error) state.error = current_exception();
+                    state.failed = true;
+                }
+            }
+            if (node.op != Op::Input) {
+                Node operands[2] = { node.left, node.right };
+                size_t count = node.left == node.right ? 1 : 2;
+                for (size_t k = 0; k < count; ++k) {
+                    if (--state.consumers[operands[k]] == 0 && !state.keep[operands[k]]) {
+                        state.values[operands[k]] = Polynomial();
+                    }
+                }
+            }
+            for (Node next : state.dependents[i]) {
+                if (--state.waiting[next] == 0) pool.submit([&execute, next] { execute(next); });
+            }
+            //    state:   run  
+            lock_guard<mutex> guard(state.lock);
+            if (--state.remaining == 0) state.done.notify_all();
+        };
+
+        for (Node i : ready) pool.submit([&execute, i] { execute(i); });
+
+        //      ,   
+        while (true) {
+            if (pool.runPending()) continue;
+            unique_lock<mutex> guard(state.lock);
+            if (state.done.wait_for(guard, chrono::milliseconds(1), [&] { return state.remaining == 0; })) break;
+        }
+        if (state.error) rethrow_exception(state.error);
+
+        map<string, Polynomial> results;
+        for (const auto& out : outputs) results[out.first] = state.values[out.second];
+        return results;
+    }
+};
+
+#ifndef POLINOM_NO_MAIN
+//     ( )
+void saveWithPrompt(PolynomialStorage& storage, const string& name, const Polynomial& poly) {
+    if (storage.contains(name)) {
+        cout << " '" << name << "'  . ? (y/n): ";
+        char choice;
+        cin >> choice;
+        cin.ignore();
+        if (tolower(choice) != 'y') return;
+    }
+    storage.insert_or_assign(name, poly);
+    cout << " '" << name << "' .\n";
+}
+
+void removeWithReport(PolynomialStorage& storage, const string& name) {
+    if (storage.erase(name)) {
+        cout << " '" << name << "' .\n";
+    }
+    else {
+        cout << " '" << name << "'  .\n";
+    }
+}
 
 void showMenu() {
     cout << "\n:\n";
@@ -485,13 +3112,13 @@ int main() {
                 getline(cin, name);
                 cout << "  (, 2x^2y - 3z + 5): ";
                 getline(cin, expr);
-                storage.add(name, Polynomial(expr));
+                saveWithPrompt(storage, name, Polynomial(expr));
             }
             else if (choice == 2) {
                 string name;
                 cout << "    : ";
                 getline(cin, name);
-                storage.remove(name);
+                removeWithReport(storage, name);
             }
             else if (choice == 3) {
                 string name;
@@ -519,7 +3146,7 @@ int main() {
                 if (tolower(save) == 'y') {
                     cout << "   : ";
                     getline(cin, resultName);
-                    storage.add(resultName, result);
+                    saveWithPrompt(storage, resultName, result);
                 }
             }
             else if (choice == 6) {
@@ -539,7 +3166,7 @@ int main() {
                 if (tolower(save) == 'y') {
                     cout << "   : ";
                     getline(cin, resultName);
-                    storage.add(resultName, result);
+                    saveWithPrompt(storage, resultName, result);
                 }
             }
             else if (choice == 7) {
@@ -559,7 +3186,7 @@ int main() {
                 if (tolower(save) == 'y') {
                     cout << "   : ";
                     getline(cin, resultName);
-                    storage.add(resultName, result);
+                    saveWithPrompt(storage, resultName, result);
                 }
             }
             else if (choice == 8) {
@@ -596,3 +3223,4 @@ int main() {
 
     return 0;
 }
+#endif
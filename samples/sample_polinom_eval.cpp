@@ -0,0 +1,83 @@
+// Сравнение способов многократного вычисления полинома:
+// почленно через pow, Polynomial::evaluate и скомпилированный план
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#define POLINOM_NO_MAIN
+#include "polinom.h"
+//---------------------------------------------------------------------------
+
+template <class F>
+double measure(F f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+  const size_t points = 1000000;
+  mt19937 gen(42);
+  uniform_real_distribution<double> dist(-1.0, 1.0);
+
+  // Плотный полином: все одночлены со степенями до 5
+  Polynomial p;
+  for (int x = 0; x <= 5; x++)
+    for (int y = 0; y <= 5; y++)
+      for (int z = 0; z <= 5; z++)
+        p.addTerm(Monomial(dist(gen), x, y, z));
+
+  vector<double> xs(points), ys(points), zs(points);
+  for (size_t i = 0; i < points; i++)
+  {
+    xs[i] = dist(gen);
+    ys[i] = dist(gen);
+    zs[i] = dist(gen);
+  }
+  vector<double> naive(points), direct(points), planned(points), single(points);
+
+  double tNaive = measure([&] {
+    for (size_t i = 0; i < points; i++)
+    {
+      double sum = 0;
+      for (const auto& term : p.getTerms())
+        sum += term.getCoefficient() * pow(xs[i], term.getPowerX()) *
+          pow(ys[i], term.getPowerY()) * pow(zs[i], term.getPowerZ());
+      naive[i] = sum;
+    }
+  });
+  double tDirect = measure([&] {
+    p.evaluate(xs.data(), ys.data(), zs.data(), direct.data(), points);
+  });
+  EvaluationPlan plan;
+  double tCompile = measure([&] { plan = p.compile(); });
+  double tPlanned = measure([&] {
+    plan.evaluate(xs.data(), ys.data(), zs.data(), planned.data(), points);
+  });
+  double tSingle = measure([&] {
+    for (size_t i = 0; i < points; i++)
+      single[i] = plan.evaluate(xs[i], ys[i], zs[i]);
+  });
+
+  double maxError = 0;
+  for (size_t i = 0; i < points; i++)
+  {
+    maxError = max(maxError, fabs(planned[i] - naive[i]));
+    maxError = max(maxError, fabs(direct[i] - naive[i]));
+    maxError = max(maxError, fabs(single[i] - naive[i]));
+  }
+
+  cout << "Terms: " << p.getTerms().size() << ", points: " << points << endl;
+  cout << "  naive (pow per term):    " << tNaive << " ms" << endl;
+  cout << "  Polynomial::evaluate:    " << tDirect << " ms" << endl;
+  cout << "  compile():               " << tCompile << " ms" << endl;
+  cout << "  plan, batch:             " << tPlanned << " ms" << endl;
+  cout << "  plan, point by point:    " << tSingle << " ms" << endl;
+  cout << "Max deviation from naive: " << maxError << endl;
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -1,5 +1,7 @@
 #include "polinom.h"
 #include <gtest.h>
+#include <cmath>
+#include <unordered_set>
 
 TEST(MonomialTest, CreationFromString) {
     Monomial m1("3x^2y");
@@ -53,6 +55,23 @@ TEST(MonomialTest, ScalarMultiplication) {
     EXPECT_EQ(result.getPowerZ(), 0);
 }
 
+TEST(MonomialTest, PackedKeyRoundTrip) {
+    Monomial m(4.0, 7, 0, 9);
+    EXPECT_EQ(m.getKey(), Monomial::makeKey(7, 0, 9));
+    EXPECT_EQ(m.getPowerX(), 7);
+    EXPECT_EQ(m.getPowerY(), 0);
+    EXPECT_EQ(m.getPowerZ(), 9);
+    EXPECT_THROW(Monomial(1.0, -1, 0, 0), runtime_error);
+}
+
+TEST(MonomialTest, KeyOrderingMatchesDegreeOrdering) {
+    EXPECT_TRUE(Monomial(1, 2, 0, 0) < Monomial(1, 1, 9, 9));
+    EXPECT_TRUE(Monomial(1, 1, 3, 0) < Monomial(1, 1, 2, 9));
+    EXPECT_TRUE(Monomial(1, 0, 0, 2) < Monomial(1, 0, 0, 1));
+    EXPECT_TRUE(Monomial(2, 1, 2, 3).isSimilar(Monomial(-5, 1, 2, 3)));
+    EXPECT_FALSE(Monomial(2, 1, 2, 3).isSimilar(Monomial(2, 1, 3, 2)));
+}
+
 TEST(PolynomialTest, CreationAndParsing) {
     Polynomial p("2x^2 + 3y - z");
     string result = p.toString();
@@ -115,3 +134,977 @@ TEST(PolynomialTest, DivisionByScalar) {
     EXPECT_TRUE(has3y);
 }
 
+TEST(PolynomialTest, AddTermCombinesAndDropsZeros) {
+    Polynomial p;
+    p.addTerm(Monomial(2, 1, 0, 0));
+    p.addTerm(Monomial(3, 0, 1, 0));
+    p.addTerm(Monomial(-2, 1, 0, 0));
+    ASSERT_EQ(p.getTerms().size(), 1);
+    EXPECT_EQ(p.getTerms()[0], Monomial(3, 0, 1, 0));
+}
+
+TEST(PolynomialTest, MergeAdditionKeepsOrderAndCancels) {
+    Polynomial p1, p2;
+    p1.addTerm(Monomial(1, 2, 0, 0));
+    p1.addTerm(Monomial(2, 0, 1, 0));
+    p1.addTerm(Monomial(5, 0, 0, 0));
+    p2.addTerm(Monomial(3, 1, 0, 0));
+    p2.addTerm(Monomial(-2, 0, 1, 0));
+    p2.addTerm(Monomial(1, 0, 0, 1));
+
+    Polynomial result = p1 + p2;
+    const auto& terms = result.getTerms();
+    ASSERT_EQ(terms.size(), 4);
+    EXPECT_EQ(terms[0], Monomial(1, 2, 0, 0));
+    EXPECT_EQ(terms[1], Monomial(3, 1, 0, 0));
+    EXPECT_EQ(terms[2], Monomial(1, 0, 0, 1));
+    EXPECT_EQ(terms[3], Monomial(5, 0, 0, 0));
+}
+
+TEST(PolynomialTest, MergeSubtraction) {
+    Polynomial p1, p2;
+    p1.addTerm(Monomial(4, 1, 1, 0));
+    p1.addTerm(Monomial(1, 0, 0, 0));
+    p2.addTerm(Monomial(4, 1, 1, 0));
+    p2.addTerm(Monomial(2, 0, 2, 0));
+
+    Polynomial result = p1 - p2;
+    ASSERT_EQ(result.getTerms().size(), 2);
+    EXPECT_EQ(result.getTerms()[0], Monomial(-2, 0, 2, 0));
+    EXPECT_EQ(result.getTerms()[1], Monomial(1, 0, 0, 0));
+    EXPECT_TRUE((p1 - p1).getTerms().empty());
+}
+
+TEST(PolynomialTest, HeapMultiplicationMatchesTermByTermProduct) {
+    Polynomial p1, p2, expected;
+    for (int i = 0; i < 4; ++i) {
+        p1.addTerm(Monomial(i + 1, i, 3 - i, i % 2));
+        p2.addTerm(Monomial(2 - i, 3 - i, i, 1));
+    }
+    for (const auto& t1 : p1.getTerms()) {
+        for (const auto& t2 : p2.getTerms()) {
+            expected.addTerm(t1 * t2);
+        }
+    }
+
+    Polynomial result = p1 * p2;
+    ASSERT_EQ(result.getTerms().size(), expected.getTerms().size());
+    for (size_t i = 0; i < result.getTerms().size(); ++i) {
+        EXPECT_EQ(result.getTerms()[i].getKey(), expected.getTerms()[i].getKey());
+        EXPECT_DOUBLE_EQ(result.getTerms()[i].getCoefficient(), expected.getTerms()[i].getCoefficient());
+    }
+}
+
+TEST(PolynomialTest, MultiplicationDegreeOverflow) {
+    Polynomial p1, p2;
+    p1.addTerm(Monomial(1, 5, 0, 0));
+    p1.addTerm(Monomial(1, 0, 0, 0));
+    p2.addTerm(Monomial(1, 5, 0, 0));
+    EXPECT_THROW(p1 * p2, runtime_error);
+    EXPECT_TRUE((p1 * Polynomial()).getTerms().empty());
+}
+
+TEST(PolynomialTest, DenseMultiplicationMatchesTermByTermProduct) {
+    Polynomial p1, p2, expected;
+    for (int x = 0; x < 3; ++x) {
+        for (int y = 0; y < 3; ++y) {
+            for (int z = 0; z < 2; ++z) {
+                p1.addTerm(Monomial(x + y - z + 0.5, x, y, z));
+                p2.addTerm(Monomial(x * y + 1, y, z, x));
+            }
+        }
+    }
+    for (const auto& t1 : p1.getTerms()) {
+        for (const auto& t2 : p2.getTerms()) {
+            expected.addTerm(t1 * t2);
+        }
+    }
+
+    Polynomial result = p1 * p2;
+    ASSERT_EQ(result.getTerms().size(), expected.getTerms().size());
+    for (size_t i = 0; i < result.getTerms().size(); ++i) {
+        EXPECT_EQ(result.getTerms()[i].getKey(), expected.getTerms()[i].getKey());
+        EXPECT_NEAR(result.getTerms()[i].getCoefficient(), expected.getTerms()[i].getCoefficient(), 1e-9);
+    }
+    EXPECT_EQ(Polynomial(p1.toDense()), p1);
+}
+
+TEST(DensePolynomialTest, AddAndMultiply) {
+    DensePolynomial a, b;
+    a.add(Monomial::makeKey(1, 0, 0), 2);
+    a.add(Monomial::makeKey(0, 0, 0), 1);
+    b.add(Monomial::makeKey(1, 0, 0), 2);
+    b.add(Monomial::makeKey(0, 0, 3), -1);
+
+    EXPECT_DOUBLE_EQ((a + b).getCoefficient(1, 0, 0), 4);
+    EXPECT_DOUBLE_EQ((a - b).getCoefficient(0, 0, 3), 1);
+    DensePolynomial c = a * b;
+    EXPECT_DOUBLE_EQ(c.getCoefficient(2, 0, 0), 4);
+    EXPECT_DOUBLE_EQ(c.getCoefficient(1, 0, 3), -2);
+    EXPECT_DOUBLE_EQ(c.getCoefficient(0, 0, 3), -1);
+    EXPECT_THROW(a.add(Monomial::makeKey(10, 0, 0), 1), runtime_error);
+}
+
+TEST(CoeffKernelsTest, AllLevelsAgreeWithScalar) {
+    const size_t n = 37;
+    vector<double> src(n), base(n);
+    for (size_t i = 0; i < n; ++i) {
+        src[i] = 0.5 * i - 3;
+        base[i] = 1.25 * i + 1;
+    }
+
+    CoeffKernels::Level levels[] = {
+        CoeffKernels::Level::Scalar, CoeffKernels::Level::Avx2, CoeffKernels::Level::Avx512
+    };
+    for (auto level : levels) {
+        CoeffKernels::setLevel(level);
+        vector<double> sum = base, diff = base, scaled = base, divided = base, fused = base;
+        CoeffKernels::add(sum.data(), src.data(), n);
+        CoeffKernels::sub(diff.data(), src.data(), n);
+        CoeffKernels::scale(scaled.data(), 3, n);
+        CoeffKernels::divide(divided.data(), 4, n);
+        CoeffKernels::axpy(fused.data(), src.data(), 2, n);
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_DOUBLE_EQ(sum[i], base[i] + src[i]);
+            EXPECT_DOUBLE_EQ(diff[i], base[i] - src[i]);
+            EXPECT_DOUBLE_EQ(scaled[i], base[i] * 3);
+            EXPECT_DOUBLE_EQ(divided[i], base[i] / 4);
+            EXPECT_DOUBLE_EQ(fused[i], base[i] + 2 * src[i]);
+        }
+    }
+    CoeffKernels::setLevel(CoeffKernels::detectedLevel());
+}
+
+TEST(DensePolynomialTest, ScaleAndDivide) {
+    DensePolynomial a;
+    a.add(Monomial::makeKey(2, 1, 0), 3);
+    EXPECT_DOUBLE_EQ((a * 2).getCoefficient(2, 1, 0), 6);
+    EXPECT_DOUBLE_EQ((a / 2).getCoefficient(2, 1, 0), 1.5);
+    EXPECT_THROW(a / 0, runtime_error);
+}
+
+TEST(PolynomialTest, TermsViewExposesSeparateArrays) {
+    Polynomial p;
+    p.addTerm(Monomial(2, 0, 1, 0));
+    p.addTerm(Monomial(-4, 3, 0, 0));
+
+    TermsView terms = p.getTerms();
+    ASSERT_EQ(terms.size(), 2);
+    EXPECT_EQ(terms.keys()[0], Monomial::makeKey(3, 0, 0));
+    EXPECT_DOUBLE_EQ(terms.coefficients()[1], 2);
+
+    vector<Monomial> collected(terms.begin(), terms.end());
+    EXPECT_EQ(collected[0], Monomial(-4, 3, 0, 0));
+    EXPECT_EQ(collected[1], Monomial(2, 0, 1, 0));
+}
+
+TEST(PolynomialTest, TermsIteratorOutlivesTemporaryView) {
+    Polynomial p("2x^2 - y + 3");
+    auto it = p.getTerms().begin();
+    auto end = p.getTerms().end();
+    EXPECT_EQ((*it).getCoefficient(), 2);
+    EXPECT_EQ((*it).getPowerX(), 2);
+    ++it;
+    EXPECT_EQ((*it).getCoefficient(), -1);
+    EXPECT_EQ(distance(it, end), 2);
+    static_assert(is_same<iterator_traits<TermsView::iterator>::iterator_category, input_iterator_tag>::value,
+                  "terms are produced by value");
+}
+
+TEST(PolynomialTest, ScaleByScalar) {
+    Polynomial p;
+    p.addTerm(Monomial(2, 1, 0, 0));
+    p.addTerm(Monomial(-3, 0, 0, 0));
+
+    Polynomial result = p * 1.5;
+    EXPECT_EQ(result.getTerms()[0], Monomial(3, 1, 0, 0));
+    EXPECT_EQ(result.getTerms()[1], Monomial(-4.5, 0, 0, 0));
+    EXPECT_TRUE((p * 0).getTerms().empty());
+}
+
+TEST(PolynomialTest, CompoundOperatorsMatchBinaryOperators) {
+    Polynomial a, b;
+    for (int i = 0; i < 5; ++i) {
+        a.addTerm(Monomial(i + 1, i, 0, 1));
+        b.addTerm(Monomial(i % 2 ? -1 : 2, 2, i, 0));
+        b.addTerm(Monomial(-(i + 1), i, 0, 1));
+    }
+
+    Polynomial sum = a, diff = a, prod = a, quot = a;
+    sum += b;
+    diff -= b;
+    prod *= b;
+    quot /= 4;
+    EXPECT_EQ(sum, a + b);
+    EXPECT_EQ(diff, a - b);
+    EXPECT_EQ(prod, a * b);
+    EXPECT_EQ(quot, a / 4);
+    EXPECT_THROW(quot /= 0, runtime_error);
+
+    Polynomial self = a;
+    self += self;
+    EXPECT_EQ(self, a * 2);
+    self -= self;
+    EXPECT_TRUE(self.getTerms().empty());
+}
+
+TEST(PolynomialTest, RvalueChainsReuseLeftOperand) {
+    Polynomial a, b, c, d;
+    a.addTerm(Monomial(1, 3, 0, 0));
+    b.addTerm(Monomial(2, 2, 0, 0));
+    c.addTerm(Monomial(-1, 3, 0, 0));
+    d.addTerm(Monomial(4, 0, 0, 0));
+
+    Polynomial chain = a + b + c - d;
+    ASSERT_EQ(chain.getTerms().size(), 2);
+    EXPECT_EQ(chain.getTerms()[0], Monomial(2, 2, 0, 0));
+    EXPECT_EQ(chain.getTerms()[1], Monomial(-4, 0, 0, 0));
+
+    Polynomial moved = Polynomial(b) + d;
+    EXPECT_EQ(moved, b + d);
+    EXPECT_EQ((b + d) / 2, Polynomial(b / 2) + d / 2);
+
+    //        ,  
+    //       
+    Polynomial p, q, r, s;
+    for (int i = 0; i < 4; ++i) {
+        p.addTerm(Monomial(1, i, 0, 0));
+        q.addTerm(Monomial(1, 0, i + 1, 0));
+        r.addTerm(Monomial(1, 0, 0, i + 1));
+        s.addTerm(Monomial(1, i + 1, 1, 0));
+    }
+    Polynomial sum = p + q;
+    EXPECT_EQ(sum.getTerms().size(), 8);
+    Polynomial grown = move(sum) + r;
+    const uint64_t* buffer = grown.getTerms().keys();
+    Polynomial longer = move(grown) - s;
+    EXPECT_EQ(longer.getTerms().size(), 16);
+    EXPECT_EQ(longer.getTerms().keys(), buffer);
+}
+
+TEST(PolyExprTest, FusedExpressionMatchesEagerArithmetic) {
+    Polynomial p1, p2, p3, p4;
+    for (int i = 0; i < 4; ++i) {
+        p1.addTerm(Monomial(i + 1, i, 1, 0));
+        p2.addTerm(Monomial(2 - i, 0, i, 2));
+        p3.addTerm(Monomial(3, i, 1, 2));
+        p4.addTerm(Monomial(-i, 1, 0, i));
+    }
+
+    Polynomial lazyResult = lazy(p1) * p2 + p3 - lazy(p4) / 2.0;
+    Polynomial eagerResult = p1 * p2 + p3 - p4 / 2.0;
+    EXPECT_EQ(lazyResult, eagerResult);
+
+    Polynomial nested;
+    nested = (lazy(p1) + p3) * (lazy(p2) - p4) - 2.0 * lazy(p1) * p1;
+    EXPECT_EQ(nested, (p1 + p3) * (p2 - p4) - p1 * p1 * 2);
+}
+
+TEST(PolyExprTest, HighDegreeSumsAndOverflow) {
+    Polynomial high, low;
+    high.addTerm(Monomial(1, 12, 0, 0));
+    low.addTerm(Monomial(2, 1, 0, 0));
+
+    Polynomial sum = lazy(high) + low - lazy(low) * 0.5;
+    ASSERT_EQ(sum.getTerms().size(), 2);
+    EXPECT_EQ(sum.getTerms()[0], Monomial(1, 12, 0, 0));
+    EXPECT_EQ(sum.getTerms()[1], Monomial(1, 1, 0, 0));
+
+    EXPECT_THROW(Polynomial(lazy(high) * low), runtime_error);
+    EXPECT_THROW(lazy(low) / 0, runtime_error);
+}
+
+TEST(PolynomialTest, ParseHandlesSpacesSignsAndDefaults) {
+    Polynomial p(" -x^2 y + 2.5 z^3 - 4 + .5xyz ");
+    ASSERT_EQ(p.getTerms().size(), 4);
+    EXPECT_EQ(p.getTerms()[0], Monomial(-1, 2, 1, 0));
+    EXPECT_EQ(p.getTerms()[1], Monomial(0.5, 1, 1, 1));
+    EXPECT_EQ(p.getTerms()[2], Monomial(2.5, 0, 0, 3));
+    EXPECT_EQ(p.getTerms()[3], Monomial(-4, 0, 0, 0));
+
+    EXPECT_TRUE(Polynomial("").getTerms().empty());
+    EXPECT_TRUE(Polynomial("x - x").getTerms().empty());
+    EXPECT_EQ(Polynomial("X^2 + 1e2"), Polynomial("x^2+100"));
+}
+
+TEST(PolynomialTest, ParseRejectsMalformedInput) {
+    EXPECT_THROW(Polynomial("2x^"), runtime_error);
+    EXPECT_THROW(Polynomial("x +"), runtime_error);
+    EXPECT_THROW(Polynomial("x y z w"), runtime_error);
+    EXPECT_THROW(Polynomial("2x 3y"), runtime_error);
+    EXPECT_THROW(Monomial("x^-1"), runtime_error);
+    EXPECT_THROW(Monomial("x+y"), runtime_error);
+}
+
+TEST(PolynomialTest, EvaluateAtPoint) {
+    Polynomial p("2x^2y - 3z + 5");
+    EXPECT_DOUBLE_EQ(p.evaluate(1, 2, 3), 2 * 1 * 2 - 9 + 5);
+    EXPECT_DOUBLE_EQ(p.evaluate(-1.5, 0.5, 0), 2 * 2.25 * 0.5 + 5);
+    EXPECT_DOUBLE_EQ(Polynomial().evaluate(1, 2, 3), 0);
+    EXPECT_DOUBLE_EQ(Polynomial("x^12 - 1").evaluate(2, 0, 0), 4095);
+}
+
+TEST(PolynomialTest, BatchEvaluationMatchesPointwise) {
+    Polynomial p("x^9y^2 - 0.5xyz + 3y^4z^5 - z + 7");
+    const size_t n = 37;
+    vector<double> xs(n), ys(n), zs(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = 0.1 * i - 1;
+        ys[i] = 1.5 - 0.05 * i;
+        zs[i] = 0.03 * i;
+    }
+
+    p.evaluate(xs.data(), ys.data(), zs.data(), out.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_DOUBLE_EQ(out[i], p.evaluate(xs[i], ys[i], zs[i]));
+        double expected = pow(xs[i], 9) * ys[i] * ys[i] - 0.5 * xs[i] * ys[i] * zs[i] +
+            3 * pow(ys[i], 4) * pow(zs[i], 5) - zs[i] + 7;
+        EXPECT_NEAR(out[i], expected, 1e-9);
+    }
+}
+
+TEST(EvaluationPlanTest, MatchesDirectEvaluation) {
+    Polynomial p("3x^9y^2z - x^9z^4 + 2x^4y^3 + x^4 - 0.5xyz + y^7 + 4z^2 - 1");
+    EvaluationPlan plan = p.compile();
+    EXPECT_EQ(plan.size(), p.getTerms().size());
+
+    const size_t n = 21;
+    vector<double> xs(n), ys(n), zs(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = 0.9 - 0.07 * i;
+        ys[i] = 0.05 * i - 0.4;
+        zs[i] = 1.1 - 0.02 * i;
+    }
+    plan.evaluate(xs.data(), ys.data(), zs.data(), out.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(out[i], p.evaluate(xs[i], ys[i], zs[i]), 1e-12);
+        EXPECT_DOUBLE_EQ(plan.evaluate(xs[i], ys[i], zs[i]), out[i]);
+    }
+
+    EXPECT_DOUBLE_EQ(Polynomial().compile().evaluate(1, 2, 3), 0);
+    EXPECT_DOUBLE_EQ(Polynomial("5").compile().evaluate(1, 2, 3), 5);
+    EXPECT_DOUBLE_EQ(Polynomial("x^12 + y").compile().evaluate(2, 3, 0), 4099);
+}
+
+TEST(ThreadPoolTest, ParallelForCoversRangeOnce) {
+    ThreadPool pool(4);
+    const size_t n = 10007;
+    vector<int> hits(n, 0);
+    pool.parallelFor(n, 100, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) hits[i]++;
+    });
+    EXPECT_EQ(count(hits.begin(), hits.end(), 1), n);
+
+    EXPECT_THROW(pool.parallelFor(n, 10, [](size_t begin, size_t) {
+        if (begin == 500) throw runtime_error("chunk failed");
+    }), runtime_error);
+}
+
+TEST(EvaluationPlanTest, ParallelEvaluationMatchesSerial) {
+    Polynomial p("x^3y - 2y^2z^2 + 0.25xz + 1");
+    EvaluationPlan plan = p.compile();
+    const size_t n = 3 * EvaluationPlan::parallelChunk + 17;
+    vector<double> xs(n), ys(n), zs(n), serial(n), parallel(n);
+    for (size_t i = 0; i < n; ++i) {
+        xs[i] = sin(0.01 * i);
+        ys[i] = cos(0.02 * i);
+        zs[i] = 0.0001 * i;
+    }
+
+    ThreadPool pool(3);
+    plan.evaluate(xs.data(), ys.data(), zs.data(), serial.data(), n);
+    plan.evaluate(xs.data(), ys.data(), zs.data(), parallel.data(), n, pool);
+    EXPECT_EQ(serial, parallel);
+}
+
+TEST(PolynomialTest, ParallelMultiplicationMatchesSerial) {
+    Polynomial p1, p2;
+    for (int x = 0; x < 5; ++x) {
+        for (int y = 0; y < 5; ++y) {
+            for (int z = 0; z < 4; ++z) {
+                if ((x + y + z) % 3 != 0) p1.addTerm(Monomial(x - y + 0.5 * z, x, y, z));
+                if ((x * y + z) % 2 == 0) p2.addTerm(Monomial(1.0 + x + z, y, z, x));
+            }
+        }
+    }
+
+    ThreadPool pool(3);
+    Polynomial parallel = p1.multiplyParallel(p2, pool);
+    Polynomial serial = p1 * p2;
+    ASSERT_EQ(parallel.getTerms().size(), serial.getTerms().size());
+    for (size_t i = 0; i < serial.getTerms().size(); ++i) {
+        EXPECT_EQ(parallel.getTerms()[i].getKey(), serial.getTerms()[i].getKey());
+        EXPECT_NEAR(parallel.getTerms()[i].getCoefficient(), serial.getTerms()[i].getCoefficient(), 1e-9);
+    }
+
+    Polynomial high("x^6 + 1");
+    EXPECT_THROW(high.multiplyParallel(high, pool), runtime_error);
+    EXPECT_TRUE(p1.multiplyParallel(Polynomial(), pool).getTerms().empty());
+}
+
+TEST(PolynomialGraphTest, SharesSubexpressionsAndMatchesDirectComputation) {
+    PolynomialStorage storage;
+    storage.insert_or_assign("a", Polynomial("x + y"));
+    storage.insert_or_assign("b", Polynomial("x - 2z"));
+    storage.insert_or_assign("c", Polynomial("3xyz + 1"));
+
+    PolynomialGraph graph;
+    auto a = graph.input("a"), b = graph.input("b"), c = graph.input("c");
+    auto ab = graph.mul(a, b);
+    EXPECT_EQ(graph.mul(b, a), ab);
+    EXPECT_EQ(graph.input("a"), a);
+    size_t before = graph.size();
+    graph.output("s", graph.add(ab, c));
+    graph.output("d", graph.sub(graph.mul(b, a), graph.divide(c, 2)));
+    graph.output("ab", ab);
+    EXPECT_EQ(graph.size(), before + 3);
+
+    ThreadPool pool(3);
+    auto results = graph.run(storage, pool);
+    Polynomial pa("x + y"), pb("x - 2z"), pc("3xyz + 1");
+    EXPECT_EQ(results["s"], pa * pb + pc);
+    EXPECT_EQ(results["d"], pa * pb - pc / 2);
+    EXPECT_EQ(results["ab"], pa * pb);
+}
+
+TEST(PolynomialGraphTest, PropagatesErrors) {
+    PolynomialStorage storage;
+    storage.insert_or_assign("p", Polynomial("x^5"));
+
+    PolynomialGraph graph;
+    auto p = graph.input("p");
+    graph.output("square", graph.mul(p, p));
+    ThreadPool pool(2);
+    EXPECT_THROW(graph.run(storage, pool), runtime_error);
+
+    PolynomialGraph missing;
+    missing.output("m", missing.add(missing.input("nope"), missing.input("p")));
+    EXPECT_THROW(missing.run(storage, pool), runtime_error);
+    EXPECT_THROW(missing.add(0, 42), runtime_error);
+}
+
+TEST(ConcurrentPolynomialStorageTest, BasicOperations) {
+    ConcurrentPolynomialStorage storage;
+    EXPECT_TRUE(storage.insert_or_assign("p", Polynomial("x + 1")));
+    EXPECT_FALSE(storage.try_insert("p", Polynomial("y")));
+    EXPECT_TRUE(storage.try_insert("q", Polynomial("y")));
+
+    auto old = storage.get("p");
+    EXPECT_FALSE(storage.insert_or_assign("p", Polynomial("z")));
+    EXPECT_EQ(*old, Polynomial("x + 1"));
+    EXPECT_EQ(*storage.get("p"), Polynomial("z"));
+    EXPECT_EQ(storage.get("q"), storage.get("q"));
+
+    EXPECT_EQ(storage.size(), 2);
+    auto entries = storage.snapshot();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].first, "p");
+    EXPECT_EQ(entries[1].first, "q");
+
+    EXPECT_TRUE(storage.erase("p"));
+    EXPECT_FALSE(storage.erase("p"));
+    EXPECT_EQ(storage.find("p"), nullptr);
+    EXPECT_THROW(storage.get("p"), runtime_error);
+}
+
+TEST(ConcurrentPolynomialStorageTest, ConcurrentUpdatesAreNotLost) {
+    ConcurrentPolynomialStorage storage;
+    storage.insert_or_assign("counter", Polynomial());
+    Polynomial one("1");
+
+    vector<thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&storage, &one, t] {
+            for (int i = 0; i < 250; ++i) {
+                storage.update("counter", [&one](const Polynomial& p) { return p + one; });
+                storage.insert_or_assign("t" + to_string(t) + "_" + to_string(i), Polynomial("x"));
+                storage.get("counter");
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_DOUBLE_EQ(storage.get("counter")->evaluate(0, 0, 0), 1000);
+    EXPECT_EQ(storage.size(), 1001);
+}
+
+TEST(PolynomialStorageTest, SilentInsertEraseAndList) {
+    PolynomialStorage storage;
+    EXPECT_TRUE(storage.try_insert("b", Polynomial("y")).second);
+    EXPECT_FALSE(storage.try_insert("b", Polynomial("z")).second);
+    EXPECT_EQ(storage.get("b"), Polynomial("y"));
+    EXPECT_TRUE(storage.insert_or_assign("a", Polynomial("x + 1")).second);
+    EXPECT_FALSE(storage.insert_or_assign("b", Polynomial("z")).second);
+    EXPECT_EQ(storage.get("b"), Polynomial("z"));
+    EXPECT_EQ(storage.size(), 2);
+
+    ostringstream out;
+    storage.list(out);
+    EXPECT_EQ(out.str(), " :\n  a = x+1\n  b = z\n");
+
+    EXPECT_TRUE(storage.erase("a"));
+    EXPECT_FALSE(storage.erase("a"));
+    EXPECT_FALSE(storage.contains("a"));
+    EXPECT_THROW(storage.get("a"), runtime_error);
+}
+
+TEST(PolynomialStorageTest, GetReferencesSurviveInserts) {
+    PolynomialStorage storage;
+    storage.insert_or_assign("a", Polynomial("x^2 - 1"));
+    const Polynomial& a = storage.get("a");
+    for (int i = 0; i < 100; ++i) storage.insert_or_assign("p" + to_string(i), Polynomial("y"));
+    EXPECT_EQ(a.toString(), "x^2-1");
+    EXPECT_EQ(&a, &storage.get("a"));
+}
+
+TEST(PolynomialStorageTest, InternedIdsAreStable) {
+    PolynomialStorage storage;
+    const int n = 1000;
+    vector<PolynomialStorage::Id> ids;
+    for (int i = 0; i < n; ++i) {
+        ids.push_back(storage.insert_or_assign("p" + to_string(i), Polynomial(to_string(i))).first);
+    }
+    for (int i = 0; i < n; ++i) {
+        EXPECT_EQ(storage.find("p" + to_string(i)), ids[i]);
+        EXPECT_EQ(storage.name(ids[i]), "p" + to_string(i));
+        EXPECT_DOUBLE_EQ(storage.get(ids[i]).evaluate(0, 0, 0), i);
+    }
+    EXPECT_EQ(storage.find("missing"), PolynomialStorage::npos);
+
+    EXPECT_TRUE(storage.erase(ids[5]));
+    EXPECT_FALSE(storage.contains(ids[5]));
+    EXPECT_THROW(storage.get(ids[5]), runtime_error);
+    EXPECT_EQ(storage.insert_or_assign("p5", Polynomial("x")).first, ids[5]);
+    EXPECT_EQ(storage.size(), n);
+
+    auto sorted = storage.sortedIds();
+    ASSERT_EQ(sorted.size(), n);
+    EXPECT_TRUE(is_sorted(sorted.begin(), sorted.end(), [&](PolynomialStorage::Id a, PolynomialStorage::Id b) {
+        return storage.name(a) < storage.name(b);
+    }));
+}
+
+TEST(PolynomialStorageTest, SnapshotRoundTrip) {
+    PolynomialStorage storage;
+    storage.insert_or_assign("zeta", Polynomial("x^9y^9z^9 - 0.125"));
+    storage.insert_or_assign("alpha", Polynomial("3x + 2y + z"));
+    storage.insert_or_assign("empty", Polynomial());
+    storage.insert_or_assign("gone", Polynomial("x"));
+    storage.erase("gone");
+
+    string path = "polinom_snapshot.bin";
+    storage.save(path);
+
+    PolynomialStorage loaded;
+    loaded.insert_or_assign("stale", Polynomial("y"));
+    loaded.load(path);
+    EXPECT_EQ(loaded.size(), 3);
+    EXPECT_FALSE(loaded.contains("stale"));
+    EXPECT_FALSE(loaded.contains("gone"));
+    for (const char* name : { "zeta", "alpha", "empty" }) {
+        EXPECT_EQ(loaded.get(name), storage.get(name));
+    }
+    remove(path.c_str());
+}
+
+TEST(PolynomialStorageTest, SnapshotRejectsBadFiles) {
+    string path = "polinom_bad_snapshot.bin";
+    {
+        ofstream out(path, ios::binary);
+        out << "definitely not a snapshot, but long enough for a header";
+    }
+    PolynomialStorage storage;
+    EXPECT_THROW(storage.load(path), runtime_error);
+    EXPECT_THROW(storage.load(path + ".missing"), runtime_error);
+    EXPECT_THROW(Polynomial::fromCanonical({ 1, 2 }, { 1.0, 1.0 }), runtime_error);
+    remove(path.c_str());
+}
+
+TEST(PolynomialStorageTest, SnapshotRejectsOversizedRecords) {
+    //   2^61 ,     16 : 
+    //        
+    string path = "polinom_oversized_snapshot.bin";
+    SnapshotHeader header;
+    copy(SnapshotHeader::expectedMagic, SnapshotHeader::expectedMagic + 8, header.magic);
+    header.version = SnapshotHeader::currentVersion;
+    header.byteOrder = SnapshotHeader::byteOrderTag;
+    header.count = 1;
+    header.indexOffset = sizeof(SnapshotHeader) + 16 + 8 + 16;
+    uint64_t sizes[2] = { 1, uint64_t(1) << 61 };
+    uint64_t offset = sizeof(SnapshotHeader);
+    {
+        ofstream out(path, ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+        out.write("p\0\0\0\0\0\0\0", 8);
+        const char terms[16] = {};
+        out.write(terms, sizeof(terms));
+        out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    PolynomialStorage storage;
+    EXPECT_THROW(storage.load(path), runtime_error);
+
+    //  ,    
+    sizes[0] = 1000;
+    sizes[1] = 0;
+    {
+        fstream out(path, ios::binary | ios::in | ios::out);
+        out.seekp(sizeof(SnapshotHeader));
+        out.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    }
+    EXPECT_THROW(storage.load(path), runtime_error);
+    remove(path.c_str());
+}
+
+TEST(MappedPolynomialStorageTest, ServesSnapshotWithoutCopying) {
+    PolynomialStorage storage;
+    storage.insert_or_assign("b", Polynomial("x^2 - 2xy + y^2"));
+    storage.insert_or_assign("a", Polynomial("7z^9"));
+    storage.insert_or_assign("c", Polynomial());
+    string path = "polinom_mapped.bin";
+    storage.save(path);
+
+    MappedPolynomialStorage mapped(path);
+    ASSERT_TRUE(mapped.isOpen());
+    EXPECT_EQ(mapped.size(), 3);
+    EXPECT_EQ(mapped.names(), (vector<string_view>{ "a", "b", "c" }));
+    EXPECT_TRUE(mapped.contains("b"));
+    EXPECT_FALSE(mapped.contains("bb"));
+    EXPECT_THROW(mapped.get("d"), runtime_error);
+
+    TermsView terms = mapped.get("b");
+    ASSERT_EQ(terms.size(), 3);
+    EXPECT_EQ(terms[1].getCoefficient(), -2);
+    EXPECT_EQ(terms[1].getPowerX(), 1);
+    EXPECT_EQ(terms[1].getPowerY(), 1);
+    EXPECT_TRUE(mapped.get("c").empty());
+    for (const char* name : { "a", "b", "c" }) {
+        EXPECT_EQ(mapped.copy(name), storage.get(name));
+    }
+
+    MappedPolynomialStorage moved = move(mapped);
+    EXPECT_FALSE(mapped.isOpen());
+    EXPECT_EQ(moved.get("a")[0].getPowerZ(), 9);
+    moved.close();
+    remove(path.c_str());
+    EXPECT_THROW(MappedPolynomialStorage("polinom_mapped.missing"), runtime_error);
+}
+
+TEST(StorageLogTest, RecoveryReplaysLogOnTopOfSnapshot) {
+    string snapshot = "polinom_wal.snap", logPath = "polinom_wal.log";
+    remove(snapshot.c_str());
+    remove(logPath.c_str());
+
+    PolynomialStorage storage;
+    {
+        StorageLog log(logPath, 4);
+        storage.attachLog(&log);
+        storage.insert_or_assign("p", Polynomial("x + 1"));
+        storage.insert_or_assign("q", Polynomial("y^2"));
+        storage.checkpoint(snapshot);
+        storage.insert_or_assign("p", Polynomial("x - 1"));
+        storage.try_insert("q", Polynomial("z"));
+        storage.try_insert("r", Polynomial("3z^3"));
+        storage.erase("q");
+        storage.attachLog(nullptr);
+    }
+
+    PolynomialStorage recovered;
+    recovered.recover(snapshot, logPath);
+    EXPECT_EQ(recovered.size(), 2);
+    EXPECT_EQ(recovered.get("p"), Polynomial("x - 1"));
+    EXPECT_EQ(recovered.get("r"), Polynomial("3z^3"));
+    EXPECT_FALSE(recovered.contains("q"));
+
+    //        
+    {
+        ofstream out(logPath, ios::binary | ios::app);
+        out.write("\x01\x05\x00\x00", 4);
+    }
+    {
+        StorageLog log(logPath);
+        log.logErase("p");
+    }
+    recovered.recover(snapshot, logPath);
+    EXPECT_EQ(recovered.size(), 1);
+    EXPECT_TRUE(recovered.contains("r"));
+    remove(snapshot.c_str());
+    remove(logPath.c_str());
+}
+
+TEST(StorageLogTest, RefusesForeignFilesAndSyncsOnDemand) {
+    string snapshot = "polinom_wal_foreign.snap", logPath = "polinom_wal_sync.log";
+    remove(logPath.c_str());
+    PolynomialStorage storage;
+    storage.insert_or_assign("p", Polynomial("x"));
+    storage.save(snapshot);
+    ifstream before(snapshot, ios::binary | ios::ate);
+    streamoff size = before.tellg();
+    before.close();
+
+    EXPECT_THROW(StorageLog log(snapshot), runtime_error);
+    ifstream after(snapshot, ios::binary | ios::ate);
+    EXPECT_EQ(after.tellg(), size);
+    after.close();
+
+    {
+        StorageLog log(logPath, 64);
+        storage.attachLog(&log);
+        storage.insert_or_assign("q", Polynomial("y"));
+        storage.syncLog();
+        //       
+        int replayed = 0;
+        StorageLog::replay(logPath, [&replayed](StorageLog::Operation, const string&, Polynomial) { ++replayed; });
+        EXPECT_EQ(replayed, 1);
+        storage.attachLog(nullptr);
+    }
+    remove(snapshot.c_str());
+    remove(logPath.c_str());
+}
+
+TEST(StorageLogTest, CopiesDoNotWriteToTheOriginalsLog) {
+    string snapshot = "polinom_wal_copy.snap", logPath = "polinom_wal_copy.log";
+    remove(snapshot.c_str());
+    remove(logPath.c_str());
+    {
+        StorageLog log(logPath, 1);
+        PolynomialStorage storage;
+        storage.attachLog(&log);
+        storage.insert_or_assign("a", Polynomial("x"));
+
+        PolynomialStorage scratch = storage;
+        scratch.erase("a");
+        scratch.insert_or_assign("tmp", Polynomial("y"));
+        PolynomialStorage assigned;
+        assigned = storage;
+        assigned.insert_or_assign("other", Polynomial("z"));
+
+        PolynomialStorage recovered;
+        recovered.recover(snapshot, logPath);
+        EXPECT_EQ(recovered.size(), 1);
+        EXPECT_TRUE(recovered.contains("a"));
+        EXPECT_FALSE(recovered.contains("tmp"));
+
+        //      
+        PolynomialStorage moved = move(storage);
+        moved.insert_or_assign("b", Polynomial("2"));
+        storage.insert_or_assign("lost", Polynomial("3"));
+        recovered.recover(snapshot, logPath);
+        EXPECT_EQ(recovered.size(), 2);
+        EXPECT_TRUE(recovered.contains("b"));
+        EXPECT_FALSE(recovered.contains("lost"));
+        moved.attachLog(nullptr);
+    }
+    remove(logPath.c_str());
+}
+
+TEST(StorageLogTest, GroupCommitFromManyThreads) {
+    string logPath = "polinom_wal_threads.log";
+    remove(logPath.c_str());
+    const int threads = 4, perThread = 50;
+    {
+        StorageLog log(logPath, 8);
+        vector<thread> writers;
+        for (int t = 0; t < threads; ++t) {
+            writers.emplace_back([&log, t]() {
+                for (int i = 0; i < perThread; ++i) {
+                    log.commit(log.logAssign("p" + to_string(t) + "_" + to_string(i), Polynomial("x")));
+                }
+            });
+        }
+        for (thread& w : writers) w.join();
+    }
+    int replayed = 0;
+    StorageLog::replay(logPath, [&replayed](StorageLog::Operation, const string&, Polynomial) { ++replayed; });
+    EXPECT_EQ(replayed, threads * perThread);
+    remove(logPath.c_str());
+}
+
+TEST(PolynomialTest, BucketSimplificationMatchesComparisonSort) {
+    //  bucketSortThreshold    
+    string text;
+    uint32_t state = 12345;
+    for (int i = 0; i < 500; ++i) {
+        state = state * 1103515245u + 12345u;
+        int px = state >> 8 & 7, py = state >> 12 & 7, pz = state >> 16 & 7;
+        int coeff = int(state >> 20 & 7) - 3;
+        text += (coeff < 0 ? " - " : " + ") + to_string(abs(coeff)) +
+                "x^" + to_string(px) + "y^" + to_string(py) + "z^" + to_string(pz);
+    }
+    ASSERT_GE(500u, Polynomial::bucketSortThreshold);
+    Polynomial bulk(text);
+
+    map<uint64_t, double> expected;
+    Polynomial single;
+    istringstream terms(text);
+    string sign, term;
+    while (terms >> sign >> term) {
+        Polynomial one((sign == "-" ? "-" : "") + term);
+        for (const Monomial& m : one.getTerms()) expected[m.getKey()] += m.getCoefficient();
+    }
+
+    TermsView view = bulk.getTerms();
+    size_t i = 0;
+    for (auto it = expected.rbegin(); it != expected.rend(); ++it) {
+        if (it->second == 0) continue;
+        ASSERT_LT(i, view.size());
+        EXPECT_EQ(view[i].getKey(), it->first);
+        EXPECT_EQ(view[i].getCoefficient(), it->second);
+        ++i;
+    }
+    EXPECT_EQ(i, view.size());
+}
+
+TEST(PolynomialTest, ParallelSimplificationMatchesSerial) {
+    vector<uint64_t> keys;
+    vector<double> coeffs;
+    uint32_t state = 777;
+    while (keys.size() < Polynomial::parallelSimplifyThreshold + 12345) {
+        state = state * 1103515245u + 12345u;
+        keys.push_back(DensePolynomial::keyAt(int((state >> 8) % DensePolynomial::volume)));
+        coeffs.push_back(double(int(state >> 20 & 15) - 8));
+    }
+
+    ThreadPool parallelPool(3), serialPool(1);
+    Polynomial parallel = Polynomial::fromTerms(keys, coeffs, &parallelPool);
+    Polynomial serial = Polynomial::fromTerms(keys, coeffs, &serialPool);
+    ASSERT_EQ(parallel.getTerms().size(), serial.getTerms().size());
+    for (size_t i = 0; i < serial.getTerms().size(); ++i) {
+        EXPECT_EQ(parallel.getTerms()[i].getKey(), serial.getTerms()[i].getKey());
+        EXPECT_EQ(parallel.getTerms()[i].getCoefficient(), serial.getTerms()[i].getCoefficient());
+    }
+
+    //   :   ,  
+    keys.push_back(Monomial::makeKey(12, 0, 0));
+    coeffs.push_back(1);
+    EXPECT_EQ(Polynomial::fromTerms(keys, coeffs, &parallelPool).getTerms()[0].getPowerX(), 12);
+    EXPECT_THROW(Polynomial::fromTerms({ 1 }, {}), runtime_error);
+}
+
+TEST(PolynomialTest, HashAndStructuralEquality) {
+    Polynomial p("3x^2y - z + 1"), q("1 - z + 3yx^2");
+    EXPECT_EQ(p, q);
+    EXPECT_EQ(p.hash(), q.hash());
+    EXPECT_EQ(hash<Polynomial>()(p), p.hash());
+
+    //    
+    size_t before = p.hash();
+    p += Polynomial("z");
+    EXPECT_NE(p, q);
+    EXPECT_NE(p.hash(), before);
+    EXPECT_EQ(p.hash(), Polynomial("3x^2y + 1").hash());
+    p *= 2.0;
+    EXPECT_EQ(p, Polynomial("6x^2y + 2"));
+
+    //    
+    EXPECT_NE(Polynomial("x + 1"), Polynomial("x + 1.0000001"));
+
+    Polynomial moved = move(q);
+    EXPECT_EQ(moved.hash(), before);
+    EXPECT_EQ(q.hash(), Polynomial().hash());
+
+    unordered_set<Polynomial> unique{ Polynomial("x"), Polynomial("x"), Polynomial("y"), Polynomial() };
+    EXPECT_EQ(unique.size(), 3);
+}
+
+TEST(SharedPolynomialTest, CopiesShareBufferUntilModified) {
+    SharedPolynomial a(Polynomial("x^2 + 1"));
+    SharedPolynomial b = a;
+    EXPECT_TRUE(a.sharesBufferWith(b));
+    EXPECT_EQ(&a.get(), &b.get());
+
+    b += SharedPolynomial(Polynomial("y"));
+    EXPECT_FALSE(a.sharesBufferWith(b));
+    EXPECT_EQ(*a, Polynomial("x^2 + 1"));
+    EXPECT_EQ(*b, Polynomial("x^2 + y + 1"));
+
+    //      
+    const Polynomial* before = &b.get();
+    b -= SharedPolynomial(Polynomial("1"));
+    EXPECT_EQ(&b.get(), before);
+    EXPECT_EQ(*(a * b), Polynomial("x^2 + 1") * Polynomial("x^2 + y"));
+}
+
+TEST(SharedPolynomialTest, InternedValuesAreDeduplicated) {
+    SharedPolynomial p = SharedPolynomial::intern(Polynomial("3xyz - 2"));
+    SharedPolynomial q = SharedPolynomial::intern(Polynomial("-2 + 3zyx"));
+    SharedPolynomial r = SharedPolynomial(Polynomial("3xyz - 2")).intern();
+    EXPECT_TRUE(p.isInterned());
+    EXPECT_TRUE(p.sharesBufferWith(q));
+    EXPECT_TRUE(p.sharesBufferWith(r));
+    EXPECT_EQ(p, q);
+    EXPECT_NE(p, SharedPolynomial::intern(Polynomial("3xyz")));
+    EXPECT_TRUE(SharedPolynomial::intern(Polynomial()).sharesBufferWith(SharedPolynomial()));
+
+    //       
+    q.update([](Polynomial& poly) { poly *= 2.0; });
+    EXPECT_FALSE(q.isInterned());
+    EXPECT_EQ(*p, Polynomial("3xyz - 2"));
+    EXPECT_EQ(hash<SharedPolynomial>()(p), Polynomial("3xyz - 2").hash());
+
+    // ,      ,   
+    for (int i = 0; i < 1000; ++i) SharedPolynomial::intern(Polynomial(to_string(i + 1) + "x"));
+    EXPECT_LT(SharedPolynomial::internTableSize(), 200);
+}
+
+TEST(PolynomialTest, FormatterMatchesStreamOutput) {
+    const double samples[] = { 1, -1, 2.5, -0.125, 1e-7, -3.14159265, 123456789.0, 1e300, -2e-300, 100000, 1234567 };
+    for (double c : samples) {
+        for (uint64_t key : { Monomial::makeKey(0, 0, 0), Monomial::makeKey(1, 0, 0),
+                              Monomial::makeKey(0, 2, 1), Monomial::makeKey(9, 9, 9) }) {
+            Monomial m = Monomial::fromKey(c, key);
+            ostringstream expected;
+            if ((c != 1 && c != -1) || key == 0) expected << c;
+            else if (c == -1) expected << "-";
+            int powers[3] = { m.getPowerX(), m.getPowerY(), m.getPowerZ() };
+            for (int v = 0; v < 3; ++v) {
+                if (powers[v] > 0) expected << "xyz"[v];
+                if (powers[v] > 1) expected << "^" << powers[v];
+            }
+            EXPECT_EQ(m.toString(), expected.str());
+        }
+    }
+
+    Polynomial p("-x^3 + 2.5x^2y - y + 1e-7z - 4");
+    EXPECT_EQ(p.toString(), "-x^3+2.5x^2y-y+1e-07z-4");
+    string out = "p = ";
+    p.appendTo(out);
+    Polynomial().appendTo(out);
+    EXPECT_EQ(out, "p = -x^3+2.5x^2y-y+1e-07z-40");
+
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    p.write(file);
+    rewind(file);
+    char buffer[64] = {};
+    EXPECT_EQ(fread(buffer, 1, sizeof(buffer) - 1, file), p.toString().size());
+    EXPECT_EQ(string(buffer), p.toString());
+    fclose(file);
+}
+
+TEST(MappedPolynomialStorageTest, RejectsRecordsPastTheEndOfFile) {
+    // ,      19 (  24) 
+    // ,      19 ,    
+    string path = "polinom_mapped_crafted.bin";
+    SnapshotHeader header;
+    copy(SnapshotHeader::expectedMagic, SnapshotHeader::expectedMagic + 8, header.magic);
+    header.version = SnapshotHeader::currentVersion;
+    header.byteOrder = SnapshotHeader::byteOrderTag;
+    header.count = 1;
+    header.indexOffset = sizeof(SnapshotHeader);
+    uint64_t offset = sizeof(SnapshotHeader) + sizeof(uint64_t);
+    uint64_t sizes[2] = { 19, 1000000 };
+    {
+        ofstream out(path, ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        out.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+        out.write("nineteen characters", 19);
+    }
+
+    MappedPolynomialStorage mapped(path);
+    EXPECT_THROW(mapped.get("nineteen characters"), runtime_error);
+    EXPECT_THROW(mapped.names(), runtime_error);
+    mapped.close();
+    remove(path.c_str());
+}